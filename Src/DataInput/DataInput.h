@@ -45,7 +45,7 @@ class DataInput {
 		/* Load the files in the given directory */
 		virtual void loadDirectory(std::string path) = 0;
 		
-		std::map<int, std::vector<Element> > getTrainingElements() { return mTrainingElements; }
+		const std::map<int, std::vector<Element> > &getTrainingElements() { return mTrainingElements; }
 		std::map<int, std::vector<Element> > &getTrainingElementsRef() { return mTrainingElements; }
 		std::vector<Element> &getTestingElements() { return mTestingElements; }
 		int getNbClasses() { return mNbClasses; }
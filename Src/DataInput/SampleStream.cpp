@@ -0,0 +1,142 @@
+/*
+ * SampleStream.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "SampleStream.h"
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+#define SAMPLE_STREAM_MAGIC 0x4f505453 //"OPTS"
+
+TrainingSetStream::TrainingSetStream(DataInput *data) {
+    mData = data;
+    rewind();
+}
+
+void TrainingSetStream::rewind() {
+    mClass = mData->getTrainingElements().begin();
+    mElement = 0;
+    mClassIndex = 0;
+}
+
+bool TrainingSetStream::next(Eigen::MatrixXd &chunk, Eigen::VectorXi &classes, long maxSamples) {
+    chunk.resize(mData->getVectorSize(), maxSamples);
+    classes.resize(maxSamples);
+    long n = 0;
+
+    while (n < maxSamples && mClass != mData->getTrainingElements().end()) {
+	if (mElement == mClass->second.size()) {
+	    mClass++;
+	    mClassIndex++;
+	    mElement = 0;
+	    continue;
+	}
+
+	chunk.col(n) = mClass->second[mElement++].data;
+	classes(n++) = mClassIndex;
+    }
+
+    chunk.conservativeResize(Eigen::NoChange, n);
+    classes.conservativeResize(n);
+
+    return n > 0;
+}
+
+
+BinaryFileStream::BinaryFileStream(std::string path) : mPath(path) {
+    mFile.open(path, std::ios::in | std::ios::binary);
+    int32_t magic = 0;
+    mFile.read((char *) &magic, sizeof(magic));
+
+    if (!mFile || magic != SAMPLE_STREAM_MAGIC) {
+	std::cout << "/!\\ COULD NOT OPEN " << path << " /!\\" << std::endl;
+	exit(1);
+    }
+
+    mFile.read((char *) &mNbSamples, sizeof(mNbSamples));
+    mFile.read((char *) &mVectorSize, sizeof(mVectorSize));
+    mFile.read((char *) &mNbClasses, sizeof(mNbClasses));
+    if (mFile && mNbSamples >= 0 && mVectorSize > 0 && mNbClasses > 0) {
+	mLabels.resize(mNbClasses);
+	mFile.read((char *) mLabels.data(), mNbClasses * sizeof(int32_t));
+    }
+
+    if (!mFile || mLabels.empty()) {
+	std::cout << "/!\\ TRUNCATED OR INVALID HEADER IN " << path << " /!\\" << std::endl;
+	exit(1);
+    }
+
+    mFirstRecord = mFile.tellg();
+    mRead = 0;
+}
+
+bool BinaryFileStream::write(std::string path, DataInput *data) {
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file)
+	return false;
+
+    int32_t magic = SAMPLE_STREAM_MAGIC, vectorSize = data->getVectorSize(), nbClasses = data->getTrainingElements().size();
+    int64_t nbSamples = data->getNbTrainingElements();
+
+    file.write((const char *) &magic, sizeof(magic));
+    file.write((const char *) &nbSamples, sizeof(nbSamples));
+    file.write((const char *) &vectorSize, sizeof(vectorSize));
+    file.write((const char *) &nbClasses, sizeof(nbClasses));
+    for (auto const &training_class : data->getTrainingElements()) {
+	int32_t label = training_class.first;
+	file.write((const char *) &label, sizeof(label));
+    }
+
+    int32_t c = 0;
+    for (auto const &training_class : data->getTrainingElements()) {
+	for (auto const &element : training_class.second) {
+	    file.write((const char *) &c, sizeof(c));
+	    file.write((const char *) element.data.data(), vectorSize * sizeof(double));
+	}
+	c++;
+    }
+
+    /* Errors such as a full disk may only show up when the buffer is flushed */
+    file.close();
+    return !file.fail();
+}
+
+void BinaryFileStream::rewind() {
+    mFile.clear();
+    mFile.seekg(mFirstRecord);
+    mRead = 0;
+}
+
+bool BinaryFileStream::next(Eigen::MatrixXd &chunk, Eigen::VectorXi &classes, long maxSamples) {
+    long n = std::min<int64_t>(maxSamples, mNbSamples - mRead);
+    chunk.resize(mVectorSize, n);
+    classes.resize(n);
+
+    long i = 0;
+    for (; i < n; i++) {
+	int32_t c = -1;
+	mFile.read((char *) &c, sizeof(c));
+	if (mFile)
+	    mFile.read((char *) chunk.col(i).data(), mVectorSize * sizeof(double));
+
+	if (!mFile || c < 0 || c >= mNbClasses)
+	    break;
+	classes(i) = c;
+    }
+
+    /* Short read or bad record: keep the complete samples, and end the stream there */
+    if (i < n) {
+	std::cout << "/!\\ " << mPath << " IS TRUNCATED OR CORRUPTED AFTER " << mRead + i << " OF "
+	    << mNbSamples << " SAMPLES /!\\" << std::endl;
+	chunk.conservativeResize(Eigen::NoChange, i);
+	classes.conservativeResize(i);
+	mNbSamples = mRead + i;
+    }
+
+    mRead += i;
+    return i > 0;
+}
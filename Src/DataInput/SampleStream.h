@@ -0,0 +1,85 @@
+/*
+ * SampleStream.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Sources handing out the training samples chunk by chunk, so that they can
+ * be processed without holding the whole training matrix in memory. Classes
+ * are given as indices in [0, nbClasses), in the order of the training map.
+ */
+
+#ifndef SAMPLESTREAM_H
+#define SAMPLESTREAM_H
+
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include "DataInput.h"
+
+class SampleStream {
+
+	public:
+		virtual ~SampleStream() {}
+
+		/* Fill chunk (D x n) and classes (n) with the next n <= maxSamples samples;
+		 * returns false once every sample has been read */
+		virtual bool next(Eigen::MatrixXd &chunk, Eigen::VectorXi &classes, long maxSamples) = 0;
+		/* Start over from the first sample */
+		virtual void rewind() = 0;
+
+		virtual int getVectorSize() = 0;
+		virtual int getNbClasses() = 0;
+};
+
+/* Training set of a loaded DataInput */
+class TrainingSetStream : public SampleStream {
+
+	private:
+		DataInput *mData;
+		std::map<int, std::vector<DataInput::Element> >::const_iterator mClass;
+		unsigned long mElement;
+		int mClassIndex;
+
+	public:
+		explicit TrainingSetStream(DataInput *data);
+
+		bool next(Eigen::MatrixXd &chunk, Eigen::VectorXi &classes, long maxSamples);
+		void rewind();
+
+		int getVectorSize() { return mData->getVectorSize(); }
+		int getNbClasses() { return mData->getTrainingElements().size(); }
+};
+
+/* Binary file: a header (magic, number of samples, vector size, number of classes,
+ * then the label of each class) followed by one record per sample: its class index
+ * as an int32 and its vector as doubles */
+class BinaryFileStream : public SampleStream {
+
+	private:
+		std::string mPath;
+		std::ifstream mFile;
+		std::streampos mFirstRecord;
+		int32_t mVectorSize;
+		int32_t mNbClasses;
+		int64_t mNbSamples;
+		int64_t mRead;
+		std::vector<int32_t> mLabels;
+
+	public:
+		/* Exits if the file cannot be opened or its header is cut short. A file cut short
+		 * later is read up to its last complete sample, with a warning */
+		explicit BinaryFileStream(std::string path);
+
+		/* Dump the training set of data to path; false if any write failed */
+		static bool write(std::string path, DataInput *data);
+
+		bool next(Eigen::MatrixXd &chunk, Eigen::VectorXi &classes, long maxSamples);
+		void rewind();
+
+		int getVectorSize() { return mVectorSize; }
+		int getNbClasses() { return mNbClasses; }
+		const std::vector<int32_t> &getLabels() { return mLabels; }
+};
+
+#endif
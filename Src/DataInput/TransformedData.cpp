@@ -0,0 +1,25 @@
+/*
+ * TransformedData.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "TransformedData.h"
+
+TransformedData::TransformedData(DataInput *source, const Eigen::MatrixXd &training, const Eigen::MatrixXd &testing)
+    : DataInput(source->getNbClasses(), 1, training.rows()) {
+    int i = 0;
+    for (auto const &training_class : source->getTrainingElements()) {
+	std::vector<Element> &elements = mTrainingElements[training_class.first];
+	elements.reserve(training_class.second.size());
+
+	for (auto const &training_element : training_class.second)
+	    elements.push_back(Element{training.col(i++), training_element.label, training_element.given_class});
+    }
+
+    i = 0;
+    mTestingElements.reserve(source->getTestingElements().size());
+    for (auto const &testing_element : source->getTestingElements())
+	mTestingElements.push_back(Element{testing.col(i++), testing_element.label, testing_element.given_class});
+}
@@ -0,0 +1,28 @@
+/*
+ * TransformedData.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Dataset derived from another one through a feature transform: same labels
+ * and same split, new vectors. It owns its elements, so the source dataset is
+ * left untouched and can still be used (or deleted) on its own.
+ */
+
+#ifndef TRANSFORMEDDATA_H
+#define TRANSFORMEDDATA_H
+
+#include "DataInput.h"
+
+class TransformedData : public DataInput {
+
+	public:
+		/* training: one column per training element of source, in the order of its
+		 * training map; testing: one column per testing element */
+		TransformedData(DataInput *source, const Eigen::MatrixXd &training, const Eigen::MatrixXd &testing);
+
+		/* Derived data is built in memory, there is nothing to load */
+		void loadDirectory(std::string path) {}
+};
+
+#endif
@@ -6,12 +6,36 @@
  */
 
 #include "Algorithm.h"
+#include "CentroidTree.h"
+#include "OnlineCentroidModel.h"
+#include "Parallel.h"
+#include "Objectives.h"
+#include "LeastSquares.h"
+#include "NormalEquations.h"
+#include "RidgePath.h"
+#include "SymmetricRankUpdate.h"
+#include "PCA.h"
+#include "IncrementalPCA.h"
+#include "SparseData.h"
+#include "BinaryData.h"
+#include "ImagePyramid.h"
+#include "MixedPrecision.h"
+#include "Metric.h"
+#include "Transform.h"
 #include <math.h>
 #include <thread>
+#include <mutex>
+#include <limits>
 #include <fstream>
 #include <iostream>
 #include <string>
 #include <ctime>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
 #include "../Eigen/Eigenvalues"
 
 Algorithm::Algorithm(MNISTData *data) {
@@ -22,6 +46,10 @@ Algorithm::Algorithm(ORLData *data) {
     input_data = data;
 }
 
+Algorithm::Algorithm(TransformedData *data) {
+    input_data = data;
+}
+
 Algorithm::~Algorithm() {
     delete input_data;
 }
@@ -52,46 +80,56 @@ double Algorithm::calculateAccuracy() {
     return positives;
 }
 
-double Algorithm::nearestClassCentroid() {
+void Algorithm::classify_centroids(const CentroidSet &centroids, bool hierarchical) {
+    /* A tree only pays off once there are more centroids than fit in one leaf */
+    if (hierarchical && centroids.size() > CENTROID_TREE_LEAF_SIZE)
+	CentroidTree(centroids).classify(input_data->getTestingElements());
+    else
+	centroids.classify(input_data->getTestingElements());
+}
+
+double Algorithm::nearestClassCentroid(bool hierarchical) {
     std::cout << "* Running nearest class centroid" << std::endl;
     clock_t begin = clock();
     /* Training part: construct the mean vector of each class */
-    std::map<int, Eigen::VectorXd> mean_class_vectors;
-
     std::cout << "\t-> Building mean class vectors..." << std::endl;
-    for (auto const& training_class : input_data->getTrainingElements()) {
-	/* Get class at index i: if class 0 is equal to "Blue", returns "Blue" */
-	mean_class_vectors[training_class.first].resize(input_data->getVectorSize()); //Set Eigen Vector size
-	mean_class_vectors[training_class.first].setZero();
-	/* Iterate through the training data for the current class */
-	for (auto const& element : training_class.second)
-	    mean_class_vectors.at(training_class.first) += element.data; //Add up this picture's vector
-
-	/* Calculate the average of the mean vector */
-	mean_class_vectors.at(training_class.first) = mean_class_vectors.at(training_class.first) / training_class.second.size();
-    }
+    CentroidSet mean_class_vectors = CentroidSet::fit(input_data->getTrainingElements(),
+	    input_data->getNbTrainingElements() > CENTROIDS_COMPENSATED_THRESHOLD);
 
     /* Classification part: classify the element to the smallest distance between
      * itself and each mean vector 
      */
     std::cout << "\t-> Running classification..." << std::endl;
-    for (auto &element : input_data->getTestingElements()) {
-	/* Calculate the distance for each mean class vector */
-	double distance = 0, minDistance = 0;
-	int optimumClass = 0;
+    classify_centroids(mean_class_vectors, hierarchical);
 
-	for (auto const& mean_class_vector : mean_class_vectors) {
-	    distance = pow(Eigen::VectorXd(element.data - mean_class_vector.second).norm(), 2.0);
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
 
-	    if (distance < minDistance || !minDistance) {
-		minDistance = distance;
-		optimumClass = mean_class_vector.first;
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+double Algorithm::onlineNearestClassCentroid(int batchSize) {
+    std::cout << "* Running online nearest class centroid" << std::endl;
+    clock_t begin = clock();
+    OnlineCentroidModel model;
+
+    /* Training part: stream the training data to the model, class after class */
+    std::cout << "\t-> Updating mean class vectors (batches of " << batchSize << ")..." << std::endl;
+    std::vector<DataInput::Element> batch;
+    for (auto const& training_class : input_data->getTrainingElements()) {
+	for (auto const& element : training_class.second) {
+	    batch.push_back(element);
+
+	    if ((int) batch.size() == batchSize) {
+		model.add(batch);
+		batch.clear();
 	    }
 	}
-
-	/* Classify the element by setting its label to the best match */
-	element.given_class = optimumClass;
     }
+    model.add(batch);
+
+    std::cout << "\t-> Running classification..." << std::endl;
+    model.classify(input_data->getTestingElements());
 
     clock_t end = clock();
     std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
@@ -99,10 +137,8 @@ double Algorithm::nearestClassCentroid() {
     return double(end - begin) / CLOCKS_PER_SEC;
 }
 
-double Algorithm::nearestSubClassCentroid(int nbSubClasses) {
-    std::cout << "* Running nearest sub-class centroid" << std::endl;
-    clock_t begin = clock();
-    /* Training part: apply K-means on the training data to find sub classes */
+/* Training part: apply K-means on the training data of each class to find its sub classes */
+CentroidSet Algorithm::fit_sub_class_centroids(int nbSubClasses) {
     bool iterate;
     double lowestDistance;
     int lowestDistanceSubClass;
@@ -160,27 +196,26 @@ double Algorithm::nearestSubClassCentroid(int nbSubClasses) {
         }
     }
 
-    /* Run NCC */
-    std::cout << "\t-> Running classification..." << std::endl;
-    for (auto &element : input_data->getTestingElements()) {
-        /* Calculate the distance for each mean class vector */
-        double distance = 0, minDistance = 0;
-        int optimumClass = 0;
-
-        for (auto const& sub_class_vectors : mean_vectors) {
-            for (auto const &mean_vector : sub_class_vectors.second) {
-                distance = pow(Eigen::VectorXd(element.data - mean_vector).norm(), 2.0);
-
-                if (distance < minDistance || !minDistance) {
-                    minDistance = distance;
-                    optimumClass = sub_class_vectors.first;
-                }
-            }
+    std::vector<int> labels;
+    Eigen::MatrixXd centroids(mean_vectors.size() * nbSubClasses, input_data->getVectorSize());
+    for (auto const& sub_class_vectors : mean_vectors) {
+        for (auto const &mean_vector : sub_class_vectors.second) {
+            centroids.row(labels.size()) = mean_vector.transpose();
+            labels.push_back(sub_class_vectors.first);
         }
-
-        /* Classify the element by setting its label to the best match */
-        element.given_class = optimumClass;
     }
+
+    return CentroidSet(centroids, labels);
+}
+
+double Algorithm::nearestSubClassCentroid(int nbSubClasses, bool hierarchical) {
+    std::cout << "* Running nearest sub-class centroid" << std::endl;
+    clock_t begin = clock();
+    CentroidSet centroids = fit_sub_class_centroids(nbSubClasses);
+
+    /* Run NCC */
+    std::cout << "\t-> Running classification..." << std::endl;
+    classify_centroids(centroids, hierarchical);
     
     clock_t end = clock();
     std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
@@ -255,40 +290,243 @@ double Algorithm::nearestNeighbour() {
 }
 
 
-void Algorithm::train_perceptrons_MSE(Eigen::MatrixXd &weights) {
-    std::cout << "\t -> Training perceptrons..." << std::endl;
-  
-    /* Initialize output vectors */
-    Eigen::MatrixXd outputVectors(input_data->getNbClasses(), input_data->getNbTrainingElements());
-    outputVectors.setOnes();
-    
-    for (int i = 0; i < outputVectors.cols(); i++)
-	outputVectors.col(i) *= -1;
+double Algorithm::blockedNearestNeighbour() {
+    std::cout << "* Running blocked nearest neighbour..." << std::endl;
+    clock_t begin = clock();
 
-    /* Train the perceptrons */
-    int n = 0, c = 0;
-    for (auto const& training_class : input_data->getTrainingElements()) {
-        for (auto const& training_element : training_class.second)
-            outputVectors(c, n++) = 1;
+    Eigen::MatrixXd training, testing;
+    SparseSamples sparse_training, sparse_testing;
+    Eigen::VectorXi classes, testing_classes;
+
+    std::vector<int> labels;
+    for (auto const &training_class : input_data->getTrainingElements())
+	labels.push_back(training_class.first);
+
+    std::vector<long> nearest;
+    if (select_storage(training, sparse_training, classes, false).isSparse()) {
+	SparseData::testing(input_data, sparse_testing);
+	SparseData::nearestNeighbours(sparse_training, sparse_testing, nearest);
+    } else {
+	build_testing_matrix(testing, testing_classes);
+	MetricSearch<EuclideanMetric>(training, EuclideanMetric()).nearest(testing, nearest);
+    }
+
+    for (unsigned long i = 0; i < nearest.size(); i++)
+	input_data->getTestingElements()[i].given_class = labels[classes(nearest[i])];
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+double Algorithm::binaryNearestNeighbour(int k, BinaryData::Kernel kernel) {
+    std::cout << "* Running binarized nearest neighbour (k = " << k << ")..." << std::endl;
+    clock_t begin = clock();
+
+    BinarySamples training, testing;
+    std::vector<int> labels, predicted;
+    BinaryData::training(input_data, training, labels);
+    BinaryData::testing(input_data, testing);
+    std::cout << "\t -> " << training.getNbWords() << " words per sample, "
+	<< training.getMemory() / 1024 << " KiB of training samples ("
+	<< BinaryData::getName(kernel == BinaryData::AUTO ? BinaryData::bestKernel() : kernel) << " kernel)" << std::endl;
+
+    BinaryData::classify(training, labels, testing, k, predicted, kernel);
+    for (unsigned long i = 0; i < predicted.size(); i++)
+	input_data->getTestingElements()[i].given_class = predicted[i];
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+double Algorithm::pyramidNearestNeighbour(int nbLevels) {
+    std::cout << "* Running coarse-to-fine nearest neighbour..." << std::endl;
+    clock_t begin = clock();
+
+    Eigen::MatrixXd training, testing;
+    Eigen::VectorXi classes, testing_classes;
+    build_training_matrix(training, classes, false);
+    build_testing_matrix(testing, testing_classes);
 
-        c++;
+    std::vector<int> labels;
+    for (auto const &training_class : input_data->getTrainingElements())
+	labels.push_back(training_class.first);
+
+    ImagePyramid pyramid(training, input_data->getWidth(), input_data->getHeight(), nbLevels);
+    training.resize(0, 0);
+    std::cout << "\t -> Levels of";
+    for (int l = 0; l < pyramid.getNbLevels(); l++)
+	std::cout << " " << pyramid.getSize(l);
+    std::cout << " dimensions" << std::endl;
+
+    std::vector<long> nearest;
+    long refined = pyramid.nearest(testing, nearest);
+    std::cout << "\t -> " << double(refined) / nearest.size() << " full resolution distances per query ("
+	<< 100.0 * refined / (nearest.size() * pyramid.getNbSamples()) << "% of a full scan)" << std::endl;
+
+    for (unsigned long i = 0; i < nearest.size(); i++)
+	input_data->getTestingElements()[i].given_class = labels[classes(nearest[i])];
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+double Algorithm::mixedPrecisionNearestNeighbour(int shortlist) {
+    std::cout << "* Running mixed precision nearest neighbour..." << std::endl;
+    clock_t begin = clock();
+
+    Eigen::MatrixXd training, testing;
+    Eigen::VectorXi classes, testing_classes;
+    build_training_matrix(training, classes, false);
+    build_testing_matrix(testing, testing_classes);
+
+    std::vector<int> labels;
+    for (auto const &training_class : input_data->getTrainingElements())
+	labels.push_back(training_class.first);
+
+    MixedPrecisionSearch search(training, shortlist);
+    std::vector<long> nearest, low_precision;
+    long reranked = search.nearest(testing, nearest, &low_precision);
+
+    /* Bytes of samples read per query: all of them in float, then the shortlist in double */
+    double average = double(reranked) / nearest.size();
+    double saved = 1 - (training.rows() * (training.cols() * sizeof(float) + average * sizeof(double)))
+	/ double(training.size() * sizeof(double));
+    long disagreements = 0;
+    for (unsigned long i = 0; i < nearest.size(); i++)
+	disagreements += classes(nearest[i]) != classes(low_precision[i]);
+
+    std::cout << "\t -> " << average << " samples re-ranked in double per query, " << saved * 100
+	<< "% of the sample bandwidth saved" << std::endl;
+    std::cout << "\t -> Float search alone: " << disagreements << " label(s) changed by the re-ranking" << std::endl;
+
+    for (unsigned long i = 0; i < nearest.size(); i++)
+	input_data->getTestingElements()[i].given_class = labels[classes(nearest[i])];
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+template <typename Metric>
+void Algorithm::classify_metric_centroids(const CentroidSet &centroids) {
+    Metric metric;
+    Eigen::MatrixXd training, testing;
+    Eigen::VectorXi classes, testing_classes;
+    if (Metric::NeedsFit) {
+	build_training_matrix(training, classes, false);
+	metric.fit(training);
+	training.resize(0, 0);
     }
+    build_testing_matrix(testing, testing_classes);
 
-    /* Build the training elements matrix */
-    int i = 0;
-    Eigen::MatrixXd training_elements_matrix(input_data->getVectorSize(), input_data->getNbTrainingElements());
-    for (auto const& training_class : input_data->getTrainingElements())
-	for (auto const& training_element : training_class.second)
-	    training_elements_matrix.col(i++) = training_element.data;
+    std::vector<long> nearest;
+    MetricSearch<Metric>(centroids.getCentroids().transpose(), metric).nearest(testing, nearest);
+
+    for (unsigned long i = 0; i < nearest.size(); i++)
+	input_data->getTestingElements()[i].given_class = centroids.getLabels()[nearest[i]];
+}
+
+template <typename Metric>
+double Algorithm::metricNearestNeighbour() {
+    std::cout << "* Running nearest neighbour (" << Metric::getName() << " distance)..." << std::endl;
+    clock_t begin = clock();
+
+    Eigen::MatrixXd training, testing;
+    Eigen::VectorXi classes, testing_classes;
+    build_training_matrix(training, classes, false);
+    build_testing_matrix(testing, testing_classes);
 
-    /* Build the identity matrix of the train elements matrix's size */
-    Eigen::MatrixXd identity(training_elements_matrix.rows(), training_elements_matrix.rows());
-    identity.setIdentity();
+    std::vector<int> labels;
+    for (auto const &training_class : input_data->getTrainingElements())
+	labels.push_back(training_class.first);
 
-    /* Get the pseudo-inverse of the transposed training data and generate weights matrix */
-    Eigen::MatrixXd m(training_elements_matrix * training_elements_matrix.transpose()
-                     + 0.001 * identity); //Make sure the matrix will be invertible
-    weights = Eigen::MatrixXd(m.inverse() * training_elements_matrix) * outputVectors.transpose();
+    Metric metric;
+    metric.fit(training);
+    std::vector<long> nearest;
+    MetricSearch<Metric>(training, metric).nearest(testing, nearest);
+
+    for (unsigned long i = 0; i < nearest.size(); i++)
+	input_data->getTestingElements()[i].given_class = labels[classes(nearest[i])];
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+template <typename Metric>
+double Algorithm::metricNearestClassCentroid() {
+    std::cout << "* Running nearest class centroid (" << Metric::getName() << " distance)" << std::endl;
+    clock_t begin = clock();
+
+    std::cout << "\t-> Building mean class vectors..." << std::endl;
+    CentroidSet centroids = CentroidSet::fit(input_data->getTrainingElements(),
+	    input_data->getNbTrainingElements() > CENTROIDS_COMPENSATED_THRESHOLD);
+
+    std::cout << "\t-> Running classification..." << std::endl;
+    classify_metric_centroids<Metric>(centroids);
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+/* The sub classes are still found by Euclidean K-means: only the classification uses the metric */
+template <typename Metric>
+double Algorithm::metricNearestSubClassCentroid(int nbSubClasses) {
+    std::cout << "* Running nearest sub-class centroid (" << Metric::getName() << " distance)" << std::endl;
+    clock_t begin = clock();
+    CentroidSet centroids = fit_sub_class_centroids(nbSubClasses);
+
+    std::cout << "\t-> Running classification..." << std::endl;
+    classify_metric_centroids<Metric>(centroids);
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+/* The metrics the classifiers are compiled for */
+template double Algorithm::metricNearestNeighbour<EuclideanMetric>();
+template double Algorithm::metricNearestNeighbour<CosineMetric>();
+template double Algorithm::metricNearestNeighbour<MahalanobisMetric>();
+template double Algorithm::metricNearestNeighbour<LpMetric<1> >();
+template double Algorithm::metricNearestNeighbour<LpMetric<Eigen::Infinity> >();
+template double Algorithm::metricNearestClassCentroid<EuclideanMetric>();
+template double Algorithm::metricNearestClassCentroid<CosineMetric>();
+template double Algorithm::metricNearestClassCentroid<MahalanobisMetric>();
+template double Algorithm::metricNearestClassCentroid<LpMetric<1> >();
+template double Algorithm::metricNearestClassCentroid<LpMetric<Eigen::Infinity> >();
+template double Algorithm::metricNearestSubClassCentroid<EuclideanMetric>(int nbSubClasses);
+template double Algorithm::metricNearestSubClassCentroid<CosineMetric>(int nbSubClasses);
+template double Algorithm::metricNearestSubClassCentroid<MahalanobisMetric>(int nbSubClasses);
+template double Algorithm::metricNearestSubClassCentroid<LpMetric<1> >(int nbSubClasses);
+template double Algorithm::metricNearestSubClassCentroid<LpMetric<Eigen::Infinity> >(int nbSubClasses);
+
+void Algorithm::train_perceptrons_MSE(Eigen::MatrixXd &weights) {
+    std::cout << "\t -> Training perceptrons..." << std::endl;
+
+    /* Build the training elements matrix, dense or sparse, and the output vectors */
+    Eigen::MatrixXd training_elements_matrix;
+    SparseSamples sparse_elements;
+    Eigen::VectorXi classes;
+    bool sparse = select_storage(training_elements_matrix, sparse_elements, classes, false).isSparse();
+    Eigen::MatrixXd targets = LeastSquares::oneVsRestTargets(classes, input_data->getNbClasses());
+
+    /* Regularized least squares, so that the system is always invertible */
+    if (sparse)
+	LeastSquares::solve(sparse_elements, targets, MSE_REGULARIZATION, weights);
+    else
+	LeastSquares::solve(training_elements_matrix, targets, MSE_REGULARIZATION, weights);
 }
 
 
@@ -322,109 +560,271 @@ double fRand(double fMin, double fMax)
     return fMin + f * (fMax - fMin);
 }
 
-void Algorithm::train_perceptrons_BPG(Eigen::MatrixXd &weights) {
-    std::cout << "\t -> Training perceptrons..." << std::endl;
+void Algorithm::build_training_matrix(Eigen::MatrixXd &samples, Eigen::VectorXi &classes, bool augment) {
+    /* One column per training element, with an extra row of ones if augmented */
+    samples.resize(input_data->getVectorSize() + (augment ? 1 : 0), input_data->getNbTrainingElements());
+    classes.resize(input_data->getNbTrainingElements());
 
-    /* Build the training elements matrix */
-    int i = 0;
-    Eigen::MatrixXd training_elements_matrix(input_data->getVectorSize(), input_data->getNbTrainingElements());
-    for (auto const& training_class : input_data->getTrainingElements())
-	for (auto const& training_element : training_class.second)
-	    training_elements_matrix.col(i++) = training_element.data;
+    int i = 0, c = 0;
+    for (auto const& training_class : input_data->getTrainingElements()) {
+	for (auto const& training_element : training_class.second) {
+	    samples.col(i).head(input_data->getVectorSize()) = training_element.data;
+	    classes(i++) = c; //Class index, in the order of the training map
+	}
+	c++;
+    }
 
-    /* Augment the data */
-    Eigen::MatrixXd augmented_data(training_elements_matrix);
-    augmented_data.conservativeResize(augmented_data.rows() + 1, Eigen::NoChange);
-    augmented_data.row(augmented_data.rows() - 1).setOnes();
+    if (augment)
+	samples.row(samples.rows() - 1).setOnes();
+}
 
-    /* Initialize the weights */
+SampleMatrix Algorithm::select_storage(Eigen::MatrixXd &dense, SparseSamples &sparse, Eigen::VectorXi &classes, bool augment) {
+    double density = SparseData::density(input_data, augment);
+    if (density >= SPARSE_DENSITY_THRESHOLD) {
+	build_training_matrix(dense, classes, augment);
+	return SampleMatrix(dense);
+    }
+
+    std::cout << "\t -> Sparse samples (" << density * 100 << "% nonzero)" << std::endl;
+    SparseData::training(input_data, sparse, classes, augment);
+    return SampleMatrix(sparse);
+}
+
+/* Hold every 10th element out for validation: the permutation puts them in the last columns.
+ * Returns the number of elements left for training */
+static long validation_split(const Eigen::VectorXi &classes, Eigen::PermutationMatrix<Eigen::Dynamic> &order,
+	Eigen::VectorXi &training_classes, Eigen::VectorXi &validation_classes) {
+    long nbElements = classes.size(), nbValidation = nbElements / 10, nbTraining = nbElements - nbValidation;
+    order.resize(nbElements);
+    training_classes.resize(nbTraining);
+    validation_classes.resize(nbValidation);
+
+    for (long i = 0, t = 0, v = 0; i < nbElements; i++) {
+	if (i % 10 == 9 && v < nbValidation) {
+	    order.indices()(nbTraining + v) = i;
+	    validation_classes(v++) = classes(i);
+	} else {
+	    order.indices()(t) = i;
+	    training_classes(t++) = classes(i);
+	}
+    }
+
+    return nbTraining;
+}
+
+/* The columns of samples in the given order: the first nbTraining ones, then the others */
+template <typename Samples>
+static void split_columns(const Samples &samples, const Eigen::PermutationMatrix<Eigen::Dynamic> &order, long nbTraining,
+	Samples &training, Samples &validation) {
+    Samples permuted = samples * order;
+    training = permuted.leftCols(nbTraining);
+    validation = permuted.rightCols(permuted.cols() - nbTraining);
+}
+
+void Algorithm::init_perceptron_weights(Eigen::MatrixXd &weights) {
     weights.resize(input_data->getVectorSize() + 1, input_data->getNbClasses());
     weights.setOnes();
     weights.row(weights.rows() - 1).setZero(); //Augment the weights
     weights *= fRand(-0.1, 0.1); //Randomly initialize
+}
 
-    /* Initialize output vectors */
-    Eigen::MatrixXd outputVectors(input_data->getNbClasses(), input_data->getNbTrainingElements());
-    outputVectors.setOnes();
-     
-    for (int i = 0; i < outputVectors.cols(); i++)
-	outputVectors.col(i) *= -1;
-    
-    /* Set the right values */
-    int n = 0, c = 0;
-    for (auto const& training_class : input_data->getTrainingElements()) {
-        for (auto const& training_element : training_class.second)
-            outputVectors(c, n++) = 1;
-
-        c++;
+/* Fraction of the samples whose highest perceptron output is their own class */
+double Algorithm::training_accuracy(const Eigen::Ref<const Eigen::MatrixXd> &weights, const SampleMatrix &samples,
+	const Eigen::VectorXi &classes) {
+    Eigen::MatrixXd outputs;
+    samples.transposedProduct(weights, outputs);
+    long positives = 0;
+
+    for (long i = 0; i < outputs.cols(); i++) {
+	Eigen::Index optimum;
+	outputs.col(i).maxCoeff(&optimum);
+	positives += optimum == classes(i);
     }
 
-    std::vector<int> misclassified_elements; //Row indexes of the criterion function
-    misclassified_elements.push_back(1); //Add a value to start the loop
-    Eigen::MatrixXd criterion_function(input_data->getNbClasses(), input_data->getNbTrainingElements());
-    criterion_function.setZero();
+    return double(positives) / outputs.cols();
+}
+
+void Algorithm::build_testing_matrix(Eigen::MatrixXd &samples, Eigen::VectorXi &classes) {
+    std::map<int, int> class_indices; //Label -> index in the order of the training map
+    for (auto const& training_class : input_data->getTrainingElements())
+	class_indices.insert(std::make_pair(training_class.first, class_indices.size()));
 
-    c = 200; //Safety counter: stop if still misclassified elements anyway
-    /* Iterate while there are misclassified elements and counter not equal to zero */
-    while (!misclassified_elements.empty() && c--) {
-	/* Update the criterion function */
-	for (int i = 0; i < input_data->getNbTrainingElements(); i++)
-	    criterion_function.col(i) = outputVectors.col(i).cwiseProduct(weights.transpose() * augmented_data.col(i));
+    samples.resize(input_data->getVectorSize(), input_data->getTestingElements().size());
+    classes.resize(input_data->getTestingElements().size());
 
-	int n = 0;
-	for (int i = 0; i < input_data->getNbClasses(); i++) {
-	    /* Empty the misclassified elements */
-	    misclassified_elements.clear();
+    int i = 0;
+    for (auto const &testing_element : input_data->getTestingElements()) {
+	auto index = class_indices.find(testing_element.label);
+	samples.col(i) = testing_element.data;
+	classes(i++) = index == class_indices.end() ? -1 : index->second;
+    }
+}
 
-	    /* Find all misclassified elements */
-	    for (int k = 0; k < criterion_function.cols(); k++)
-		if (criterion_function(n, k) < 0) //Misclassified !
-		    misclassified_elements.push_back(k); //Add the col index to the list
+double Algorithm::train_perceptrons_BPG(Eigen::MatrixXd &weights, double targetAccuracy) {
+    std::cout << "\t -> Training perceptrons..." << std::endl;
 
-	    /* Calculate the gradient and update the weights */
-	    Eigen::VectorXd gradient(weights.rows());
-	    gradient.setZero();
+    /* Build the augmented training elements matrix and the class of each column */
+    Eigen::MatrixXd augmented_data;
+    SparseSamples sparse_data;
+    Eigen::VectorXi classes;
+    SampleMatrix samples = select_storage(augmented_data, sparse_data, classes, true);
 
-	    for (auto const &misclassified_element : misclassified_elements)
-		gradient += augmented_data.col(misclassified_element) * outputVectors(n, misclassified_element);
+    /* Initialize the weights */
+    init_perceptron_weights(weights);
+
+    /* Early stopping uses the same rule as SGD: argmax accuracy of the whole weight matrix.
+     * Every class publishes its parameters after each iteration; once all the running
+     * classes are past a new iteration, the assembled matrix is evaluated and the shared
+     * flag stops every task. finished marks a class whose optimizer returned */
+    const int finished = std::numeric_limits<int>::max();
+    std::mutex mutex;
+    std::atomic<bool> reached(false);
+    std::vector<int> progress(weights.cols(), 0); //Iterations done by each class
+    int checked = 0; //Last iteration reached by all classes that was evaluated
+    auto report = [&](long c, const Eigen::VectorXd &parameters, int iterations) {
+	Eigen::MatrixXd snapshot;
+	{
+	    std::lock_guard<std::mutex> lock(mutex);
+	    weights.col(c) = parameters;
+	    progress[c] = iterations;
+	    int round = *std::min_element(progress.begin(), progress.end());
+	    if (!targetAccuracy || round <= checked || round == finished)
+		return bool(reached);
+	    checked = round;
+	    snapshot = weights;
+	}
 
-	    gradient *= LEARNING_RATE;
+	if (training_accuracy(snapshot, samples, classes) >= targetAccuracy)
+	    reached = true;
+	return bool(reached);
+    };
+
+    /* One-vs-rest: every class has its own perceptron, trained as an independent
+     * task by fixed step gradient descent on its criterion. Each one stops as soon
+     * as none of its elements is misclassified, since its gradient is then zero.
+     * With a target, each class gets its own thread so that they progress together */
+    parallelFor(weights.cols(), [&](long c) {
+	PerceptronObjective criterion(samples, classes, 1, c);
+	GradientDescent optimizer(LEARNING_RATE);
+	optimizer.setStoppingCriteria(200, 0, 0); //Safety counter: stop if still misclassified elements anyway
+	if (targetAccuracy)
+	    optimizer.setCallback([&](int k, const Eigen::VectorXd &x, double) { return report(c, x, k + 1); });
+
+	Eigen::VectorXd parameters(weights.col(c));
+	optimizer.minimize(criterion, parameters);
+	report(c, parameters, finished);
+    }, targetAccuracy ? weights.cols() : 0);
+
+    return targetAccuracy ? training_accuracy(weights, samples, classes) : 0;
+}
 
-	    /* Update the weights */
-	    weights.col(n) += gradient;
+/* The given columns of samples, in order, as the columns of batch */
+static void gather_columns(const Eigen::MatrixXd &samples, const long *indices, long count, Eigen::MatrixXd &batch) {
+    batch.resize(samples.rows(), count);
+    for (long j = 0; j < count; j++)
+	batch.col(j) = samples.col(indices[j]);
+}
 
-	    n++; //Next class index (don't use i because of the offset of ORL
-	}
+static void gather_columns(const SparseSamples &samples, const long *indices, long count, SparseSamples &batch) {
+    long nonzeros = 0;
+    for (long j = 0; j < count; j++)
+	nonzeros += samples.col(indices[j]).nonZeros();
+
+    batch.resize(samples.rows(), count);
+    batch.reserve(nonzeros);
+    for (long j = 0; j < count; j++) {
+	batch.startVec(j);
+	for (SparseSamples::InnerIterator it(samples, indices[j]); it; ++it)
+	    batch.insertBack(it.row(), j) = it.value();
     }
+    batch.finalize();
 }
 
-void Algorithm::classify_perceptrons_BPG(Eigen::MatrixXd weights) {
-    std::cout << "\t -> Classifying..." << std::endl;
+/* One thread's share of an SGD epoch: the mini-batches of permutation[from, to). Returns
+ * the number of outputs on the wrong side of zero */
+template <typename Samples>
+static long sgd_slice(const Samples &samples, const Eigen::VectorXi &classes, const std::vector<long> &permutation,
+	long from, long to, int batchSize, Eigen::MatrixXd &weights) {
+    Samples batch;
+    Eigen::MatrixXd outputs, misclassified(weights.cols(), batchSize);
+    Eigen::MatrixXd gradient(weights.rows(), weights.cols());
+    long nbMisclassified = 0;
+
+    for (long start = from; start < to; start += batchSize) {
+	long count = std::min<long>(batchSize, to - start);
+	gather_columns(samples, &permutation[start], count, batch);
+
+	outputs.noalias() = weights.transpose() * batch;
+
+	long wrong_count = 0;
+	for (long j = 0; j < count; j++) {
+	    for (long n = 0; n < outputs.rows(); n++) {
+		double y = classes(permutation[start + j]) == n ? 1 : -1;
+		bool wrong = y * outputs(n, j) < 0;
+		misclassified(n, j) = wrong ? y : 0;
+		wrong_count += wrong;
+	    }
+	}
 
-    /* Build the testing elements matrix */
-    int n = 0;
-    Eigen::MatrixXd testing_elements_matrix(input_data->getVectorSize(), input_data->getTestingElements().size());
-    for (auto const &testing_element : input_data->getTestingElements()) {
-	testing_elements_matrix.col(n) = testing_element.data;
-	n++;
-    }
+	if (!wrong_count)
+	    continue;
 
-    /* Augment the data */
-    Eigen::MatrixXd augmented_test_elements(testing_elements_matrix);
-    augmented_test_elements.conservativeResize(augmented_test_elements.rows() + 1, Eigen::NoChange);
-    augmented_test_elements.row(augmented_test_elements.rows() - 1).setZero();
+	nbMisclassified += wrong_count;
+	gradient.noalias() = batch * misclassified.leftCols(count).transpose();
+	weights.noalias() += LEARNING_RATE * gradient;
+    }
 
-    /* Compute classification */
-    Eigen::MatrixXd computed_elements(weights.transpose() * augmented_test_elements);
-    n = 0;
-    for (auto const &training_class : input_data->getTrainingElements()) {
-	for (int i = 0; i < computed_elements.cols(); i++) {
-	    if (computed_elements.row(n)(i) > 0)
-		input_data->getTestingElements().at(i).given_class = training_class.first;
+    return nbMisclassified;
+}
 
+double Algorithm::train_perceptrons_SGD(Eigen::MatrixXd &weights, int batchSize, double targetAccuracy,
+	unsigned int nbThreads) {
+    if (batchSize <= 0)
+	throw std::invalid_argument("SGD mini-batch size must be positive, got " + std::to_string(batchSize));
+
+    std::cout << "\t -> Training perceptrons (mini-batches of " << batchSize << ")..." << std::endl;
+
+    Eigen::MatrixXd augmented_data;
+    SparseSamples sparse_data;
+    Eigen::VectorXi classes;
+    SampleMatrix samples = select_storage(augmented_data, sparse_data, classes, true);
+    init_perceptron_weights(weights);
+
+    if (!nbThreads)
+	nbThreads = nbWorkerThreads();
+
+    std::vector<long> permutation(samples.cols());
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::mt19937 generator(rand());
+    double accuracy = 0;
+
+    for (int epoch = 0; epoch < SGD_MAX_EPOCHS; epoch++) {
+	std::shuffle(permutation.begin(), permutation.end(), generator);
+	std::atomic<long> nbMisclassified(0);
+
+	/* Hogwild: every thread walks its own slice of the permutation and updates the
+	 * shared weights without any locking. Updates are sparse in time relative to the
+	 * products, so the occasional overlapping write costs less than synchronizing */
+	parallelFor(nbThreads, [&](long thread) {
+	    long from = permutation.size() * thread / nbThreads;
+	    long to = permutation.size() * (thread + 1) / nbThreads;
+	    if (samples.isSparse())
+		nbMisclassified += sgd_slice(sparse_data, classes, permutation, from, to, batchSize, weights);
+	    else
+		nbMisclassified += sgd_slice(augmented_data, classes, permutation, from, to, batchSize, weights);
+	}, nbThreads);
+
+	/* No output on the wrong side of zero: the true class always has the highest one */
+	if (!nbMisclassified) {
+	    accuracy = 1;
+	    break;
 	}
-	n++;
+
+	if (targetAccuracy && (accuracy = training_accuracy(weights, samples, classes)) >= targetAccuracy)
+	    break;
     }
+
+    return targetAccuracy ? accuracy : 0;
 }
 
 double Algorithm::perceptronBPG() {
@@ -433,7 +833,7 @@ double Algorithm::perceptronBPG() {
 
     Eigen::MatrixXd weights;
     train_perceptrons_BPG(weights);
-    classify_perceptrons_BPG(weights);
+    classify_argmax(weights); //Same rule as the training accuracy
 
     clock_t end = clock();
     std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
@@ -442,12 +842,212 @@ double Algorithm::perceptronBPG() {
 }
 
 
-double Algorithm::perceptronMSE() {
-    std::cout << "* Running a neural network of perceptrons using Minimal Square Error..." << std::endl;
+double Algorithm::perceptronSGD(int batchSize) {
+    std::cout << "* Running a neural network of perceptrons using mini-batch SGD..." << std::endl;
     clock_t begin = clock();
 
     Eigen::MatrixXd weights;
-    train_perceptrons_MSE(weights);
+    train_perceptrons_SGD(weights, batchSize);
+    classify_argmax(weights); //Same rule as the training accuracy
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+    
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+/* Counts the evaluations of an objective, each one a pass over its training set */
+class CountingObjective : public Objective {
+
+	private:
+		Objective &mObjective;
+		long mNbEvaluations;
+
+	public:
+		explicit CountingObjective(Objective &objective) : mObjective(objective), mNbEvaluations(0) {}
+
+		double evaluate(const Eigen::VectorXd &x, Eigen::VectorXd &gradient) {
+		    mNbEvaluations++;
+		    return mObjective.evaluate(x, gradient);
+		}
+		long getNbEvaluations() const { return mNbEvaluations; }
+};
+
+std::vector<double> Algorithm::benchmarkPerceptronTrainers(double targetAccuracy, int batchSize) {
+    std::cout << "* Time to reach " << targetAccuracy * 100 << "% training accuracy..." << std::endl;
+    std::vector<double> row;
+    Eigen::MatrixXd weights;
+
+    /* Wall time: clock() would add up the CPU time of every SGD thread */
+    auto begin = std::chrono::steady_clock::now();
+    double accuracy = train_perceptrons_BPG(weights, targetAccuracy);
+    row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    row.push_back(accuracy);
+
+    begin = std::chrono::steady_clock::now();
+    accuracy = train_perceptrons_SGD(weights, batchSize, targetAccuracy);
+    row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    row.push_back(accuracy);
+
+    /* Softmax regression: the same objective minimized by every optimizer, without regularization
+     * nor early stopping, until the argmax training accuracy reaches the target */
+    Eigen::MatrixXd augmented_data;
+    SparseSamples sparse_data;
+    Eigen::VectorXi classes;
+    SampleMatrix samples = select_storage(augmented_data, sparse_data, classes, true);
+    SoftmaxObjective softmax(samples, classes, input_data->getNbClasses(), 0);
+    long size = input_data->getVectorSize() + 1;
+
+    GradientDescent descent(SOFTMAX_LEARNING_RATE);
+    GradientDescent momentum(SOFTMAX_LEARNING_RATE, SOFTMAX_MOMENTUM);
+    GradientDescent nesterov(SOFTMAX_LEARNING_RATE, SOFTMAX_MOMENTUM, true);
+    Adam adam(SOFTMAX_LEARNING_RATE);
+    LBFGS lbfgs;
+    Optimizer *optimizers[] = {&descent, &momentum, &nesterov, &adam, &lbfgs};
+    for (Optimizer *optimizer : optimizers) {
+	CountingObjective objective(softmax);
+	optimizer->setStoppingCriteria(OPTIMIZER_MAX_ITERATIONS, 0, 0);
+	optimizer->setCallback([&](int, const Eigen::VectorXd &x, double) {
+	    accuracy = training_accuracy(Eigen::Map<const Eigen::MatrixXd>(x.data(), size, input_data->getNbClasses()), samples, classes);
+	    return accuracy >= targetAccuracy;
+	});
+
+	Eigen::VectorXd parameters(Eigen::VectorXd::Zero(size * input_data->getNbClasses()));
+	accuracy = 0;
+	begin = std::chrono::steady_clock::now();
+	optimizer->minimize(objective, parameters);
+	row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+	row.push_back(accuracy);
+	row.push_back(objective.getNbEvaluations());
+    }
+
+    /* A trainer that hit its iteration or epoch cap did not reach the target: its time is not comparable */
+    const char *names[] = {"Full batch", "mini-batch SGD", "Softmax, gradient descent", "Softmax, momentum",
+	"Softmax, Nesterov", "Softmax, Adam", "Softmax, L-BFGS"};
+    for (int t = 0, i = 0; t < 7; i += t < 2 ? 2 : 3, t++) {
+	std::cout << "\t-> " << names[t] << ": ";
+	if (row[i + 1] >= targetAccuracy)
+	    std::cout << row[i] << "s";
+	else
+	    std::cout << "not reached (" << row[i + 1] * 100 << "% after " << row[i] << "s)";
+	if (t >= 2)
+	    std::cout << ", " << row[i + 2] << " passes";
+	std::cout << std::endl;
+    }
+    std::cout << std::endl;
+
+    return row;
+}
+
+std::vector<double> Algorithm::benchmarkMSESolvers(const std::vector<double> &lambdas, std::string path) {
+    std::cout << "* Benchmarking the MSE solvers..." << std::endl << std::endl;
+    long size = input_data->getVectorSize();
+    std::vector<double> row;
+
+    /* Wall time: the Cholesky path builds its Gram matrix with the parallel SYRK */
+    auto begin = std::chrono::steady_clock::now();
+    perceptronMSE();
+    row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    row.push_back(calculateAccuracy());
+
+    begin = std::chrono::steady_clock::now();
+    perceptronMSEConjugateGradient();
+    row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    row.push_back(calculateAccuracy());
+
+    begin = std::chrono::steady_clock::now();
+    perceptronMSEPath(lambdas);
+    row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    row.push_back(calculateAccuracy());
+
+    /* Only the reading of the file is timed, not its writing */
+    bool written = BinaryFileStream::write(path, input_data);
+    if (written) {
+	begin = std::chrono::steady_clock::now();
+	perceptronMSEStreaming(NORMAL_EQUATIONS_CHUNK_SIZE, path);
+	row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+	row.push_back(calculateAccuracy());
+    }
+    std::remove(path.c_str());
+
+    /* Row: {wall time, accuracy} of Cholesky, conjugate gradient, the path, then streaming if the file was written */
+    std::cout << "* MSE perceptrons, " << size << "x" << size << " normal equations ("
+	<< size * size * sizeof(double) / 1048576.0 << " MB)" << std::endl;
+    std::cout << "\t -> Cholesky: " << row[0] << "s, " << row[1] * 100 << "%" << std::endl;
+    std::cout << "\t -> Conjugate gradient: " << row[2] << "s (x" << row[0] / row[2] << "), "
+	<< row[3] * 100 << "%" << std::endl;
+    std::cout << "\t -> Path of " << lambdas.size() << " lambdas: " << row[4] << "s (" << row[4] / row[0]
+	<< " Cholesky solves), " << row[5] * 100 << "%" << std::endl;
+    if (written)
+	std::cout << "\t -> Streamed from " << path << ": " << row[6] << "s, " << row[7] * 100 << "%" << std::endl;
+    else
+	std::cout << "\t -> Streamed: could not write " << path << std::endl;
+    std::cout << std::endl;
+
+    return row;
+}
+
+std::vector<double> Algorithm::perceptronMSEPath(const std::vector<double> &lambdas) {
+    std::cout << "* Running a neural network of perceptrons using Minimal Square Error (" << lambdas.size()
+	<< " regularizations)..." << std::endl;
+    if (lambdas.empty()) {
+	std::cout << "\t -> No regularization to try" << std::endl << std::endl;
+	return std::vector<double>();
+    }
+    clock_t begin = clock();
+
+    /* lambda is chosen on validation elements held out of the training set */
+    Eigen::MatrixXd samples, training, validation;
+    Eigen::VectorXi classes, training_classes, validation_classes;
+    Eigen::PermutationMatrix<Eigen::Dynamic> order;
+    build_training_matrix(samples, classes, false);
+    long nbTraining = validation_split(classes, order, training_classes, validation_classes);
+    split_columns(samples, order, nbTraining, training, validation);
+    samples.resize(0, 0);
+
+    /* One eigendecomposition for the whole path */
+    RidgePath path(training, LeastSquares::oneVsRestTargets(training_classes, input_data->getNbClasses()));
+    std::vector<double> accuracies = path.accuracies(lambdas, validation, validation_classes);
+
+    unsigned long best = 0;
+    for (unsigned long l = 0; l < lambdas.size(); l++) {
+	std::cout << "\t -> lambda = " << lambdas[l] << ": " << accuracies[l] * 100 << "% on validation" << std::endl;
+	if (accuracies[l] > accuracies[best])
+	    best = l;
+    }
+
+    /* Classify the test set with the best regularization, by the same argmax rule (no bias: zero last row) */
+    Eigen::MatrixXd weights;
+    path.weights(lambdas[best], weights);
+    weights.conservativeResize(weights.rows() + 1, Eigen::NoChange);
+    weights.row(weights.rows() - 1).setZero();
+    classify_argmax(weights);
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => lambda = " << lambdas[best] << ", accuracy: " << calculateAccuracy() * 100
+	<< "% (" << double(end - begin) / CLOCKS_PER_SEC << "s)" << std::endl << std::endl;
+
+    return accuracies;
+}
+
+double Algorithm::perceptronMSEStreaming(long chunkSize, std::string path) {
+    std::cout << "* Running a neural network of perceptrons using Minimal Square Error (streamed)..." << std::endl;
+    clock_t begin = clock();
+
+    /* Read the training samples chunk by chunk, from the loader or from a binary file */
+    SampleStream *stream;
+    if (path.empty())
+	stream = new TrainingSetStream(input_data);
+    else
+	stream = new BinaryFileStream(path);
+
+    std::cout << "\t -> Accumulating normal equations (chunks of " << chunkSize << ")..." << std::endl;
+    NormalEquations equations(stream->getVectorSize(), stream->getNbClasses());
+    equations.accumulate(*stream, chunkSize);
+    delete stream;
+
+    Eigen::MatrixXd weights;
+    equations.solve(MSE_REGULARIZATION, weights);
     classify_perceptrons_MSE(weights);
 
     clock_t end = clock();
@@ -456,101 +1056,413 @@ double Algorithm::perceptronMSE() {
     return double(end - begin) / CLOCKS_PER_SEC;
 }
 
-void Algorithm::applyPCA() {
-    std::cout << "* Applying PCA..." << std::endl;
+double Algorithm::perceptronMSEConjugateGradient(double tolerance, int maxIterations) {
+    std::cout << "* Running a neural network of perceptrons using Minimal Square Error (conjugate gradient)..." << std::endl;
+    clock_t begin = clock();
 
-    Eigen::MatrixXd D;
-    D.resize(input_data->getVectorSize(), 0);
-    int i = 0;
+    Eigen::MatrixXd training_elements_matrix, weights;
+    SparseSamples sparse_elements;
+    Eigen::VectorXi classes;
+    bool sparse = select_storage(training_elements_matrix, sparse_elements, classes, false).isSparse();
+    Eigen::MatrixXd targets = LeastSquares::oneVsRestTargets(classes, input_data->getNbClasses());
+
+    if (sparse)
+	LeastSquares::solveConjugateGradient(sparse_elements, targets, MSE_REGULARIZATION, weights, tolerance, maxIterations);
+    else
+	LeastSquares::solveConjugateGradient(training_elements_matrix, targets, MSE_REGULARIZATION, weights, tolerance,
+	    maxIterations);
+    classify_perceptrons_MSE(weights);
 
-    /* Join all training samples to one matrix */
-    for (auto const& training_class : input_data->getTrainingElements()) {
-	for (auto const &element : training_class.second) {
-	    D.conservativeResize(Eigen::NoChange, D.cols() + 1);
-	    D.col(D.cols() - 1) = element.data;
-	}
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
+
+void Algorithm::train_softmax(Eigen::MatrixXd &weights, double lambda) {
+    std::cout << "\t -> Training softmax regression (L-BFGS)..." << std::endl;
+
+    Eigen::MatrixXd augmented_data;
+    SparseSamples sparse_data;
+    Eigen::VectorXi classes;
+    bool sparse = select_storage(augmented_data, sparse_data, classes, true).isSparse();
+
+    /* Validation elements for early stopping */
+    Eigen::PermutationMatrix<Eigen::Dynamic> order;
+    Eigen::VectorXi training_classes, validation_classes;
+    long nbTraining = validation_split(classes, order, training_classes, validation_classes);
+
+    Eigen::MatrixXd training, validation;
+    SparseSamples sparse_training, sparse_validation;
+    if (sparse)
+	split_columns(sparse_data, order, nbTraining, sparse_training, sparse_validation);
+    else
+	split_columns(augmented_data, order, nbTraining, training, validation);
+    augmented_data.resize(0, 0);
+    sparse_data = SparseSamples();
+
+    SoftmaxObjective objective(sparse ? SampleMatrix(sparse_training) : SampleMatrix(training), training_classes,
+	input_data->getNbClasses(), lambda);
+    SoftmaxObjective validation_objective(sparse ? SampleMatrix(sparse_validation) : SampleMatrix(validation),
+	validation_classes, input_data->getNbClasses(), lambda);
+    long size = input_data->getVectorSize() + 1;
+
+    LBFGS optimizer;
+    optimizer.setStoppingCriteria(OPTIMIZER_MAX_ITERATIONS, 1e-5, 1e-9);
+    if (validation_classes.size())
+	optimizer.setEarlyStopping([&](const Eigen::VectorXd &parameters) {
+	    return validation_objective.loss(parameters);
+	}, SOFTMAX_PATIENCE);
+
+    Eigen::VectorXd parameters(Eigen::VectorXd::Zero(size * input_data->getNbClasses()));
+    int iterations = optimizer.minimize(objective, parameters);
+    std::cout << "\t -> Converged after " << iterations << " iterations" << std::endl;
+
+    weights = Eigen::Map<Eigen::MatrixXd>(parameters.data(), size, input_data->getNbClasses());
+}
+
+void Algorithm::classify_argmax(const Eigen::MatrixXd &weights) {
+    std::cout << "\t -> Classifying..." << std::endl;
+
+    std::vector<int> labels;
+    for (auto const &training_class : input_data->getTrainingElements())
+	labels.push_back(training_class.first);
+
+    /* Augment the test elements with a one, and pick the class with the highest output */
+    Eigen::VectorXd augmented(weights.rows());
+    augmented(augmented.size() - 1) = 1;
+    for (auto &testing_element : input_data->getTestingElements()) {
+	augmented.head(augmented.size() - 1) = testing_element.data;
+
+	Eigen::Index optimum;
+	(weights.transpose() * augmented).maxCoeff(&optimum);
+	testing_element.given_class = labels[optimum];
     }
+}
 
-    // 1. Compute the mean image
-    training_data_mean_vector = D.rowwise().mean().transpose();
+double Algorithm::softmaxRegression(double lambda) {
+    std::cout << "* Running softmax regression..." << std::endl;
+    clock_t begin = clock();
 
-    // 2. Subtract mean image from the data set to get mean centered data vector
-    Eigen::MatrixXd centered(D.colwise() - training_data_mean_vector);
+    Eigen::MatrixXd weights;
+    train_softmax(weights, lambda);
+    classify_argmax(weights);
 
-    // 3. Compute the covariance matrix from the mean centered data matrix
-    Eigen::MatrixXd covariance = centered * centered.transpose();
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
+    
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
 
-    // 4. Calculate the eigenvalues and eigen vectors for the covariance matrix
-    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(covariance);
-    Eigen::MatrixXd eigenVectors = eig.eigenvectors();
-    Eigen::VectorXd eigenValues = eig.eigenvalues();
+double Algorithm::perceptronMSE() {
+    std::cout << "* Running a neural network of perceptrons using Minimal Square Error..." << std::endl;
+    clock_t begin = clock();
 
-    /* Make a matrix of the two last (sorted) eigen vectors */
-    Eigen::MatrixXd pca_matrix(eigenVectors.row(eigenValues.size() - 1).transpose().rows(), 2);
-    pca_matrix.col(0) = eigenVectors.row(eigenValues.size() - 1).transpose();
-    pca_matrix.col(1) = eigenVectors.row(eigenValues.size() - 2).transpose();
+    Eigen::MatrixXd weights;
+    train_perceptrons_MSE(weights);
+    classify_perceptrons_MSE(weights);
+
+    clock_t end = clock();
+    std::cout << std::endl << "* Done ! => Accuracy: " << calculateAccuracy() * 100 << "%" << std::endl << std::endl;
     
-    training_data_eigen_vectors = pca_matrix;
+    return double(end - begin) / CLOCKS_PER_SEC;
+}
 
-    /* Apply PCA */
+void Algorithm::apply_projection(const ProjectionModel &model, const Eigen::MatrixXd &training) {
+    /* One product for all the training samples, one for all the testing samples */
+    Eigen::MatrixXd testing, projected;
+    Eigen::VectorXi testing_classes;
+    model.project(training, projected);
+
+    int i = 0;
     for (auto &training_class : input_data->getTrainingElementsRef())
 	for (auto &training_element : training_class.second)
-	    training_element.data = pca_matrix.transpose() * training_element.data;
+	    training_element.data = projected.col(i++);
 
-    /* Normalize testing data */
-    for (auto &testing_element : input_data->getTestingElements()) {
-	testing_element.data = testing_element.data - training_data_mean_vector;
-	testing_element.data = pca_matrix.transpose() * testing_element.data;
-    }
+    build_testing_matrix(testing, testing_classes);
+    model.project(testing, projected);
+
+    i = 0;
+    for (auto &testing_element : input_data->getTestingElements())
+	testing_element.data = projected.col(i++);
 
     input_data->setWidth(1);
-    input_data->setHeight(2);
+    input_data->setHeight(model.getNbComponents());
+}
+
+void Algorithm::apply_pipeline(TransformPipeline &pipeline) {
+    TransformedData *transformed = pipeline.transform(input_data);
+    delete input_data;
+    input_data = transformed;
+}
+
+void Algorithm::applyIncrementalPCA(int nbComponents, long batchSize, std::string path) {
+    std::cout << "* Applying incremental PCA (batches of " << batchSize << ")..." << std::endl;
+
+    /* From the loaded training set, this is a pipeline step */
+    if (path.empty()) {
+	TransformPipeline pipeline;
+	pipeline.add(new IncrementalPCATransform(nbComponents, batchSize));
+	apply_pipeline(pipeline);
+	std::cout << "* PCA applied !" << std::endl << std::endl;
+	return;
+    }
+
+    /* Read the training samples batch by batch from a binary file */
+    auto begin = std::chrono::steady_clock::now();
+    BinaryFileStream stream(path);
+    IncrementalPCA pca(stream.getVectorSize(), nbComponents);
+    pca.update(stream, batchSize);
+    auto end = std::chrono::steady_clock::now();
+
+    ProjectionModel model = pca.model();
+    std::cout << "\t -> " << model.getNbComponents() << " components from " << pca.getNbSamples() << " samples in "
+	<< std::chrono::duration<double>(end - begin).count() << "s" << std::endl;
+
+    Eigen::MatrixXd samples;
+    Eigen::VectorXi classes;
+    build_training_matrix(samples, classes, false);
+    apply_projection(model, samples);
 
     std::cout << "* PCA applied !" << std::endl << std::endl;
+}
+
+void Algorithm::applyLDA(int nbComponents) {
+    std::cout << "* Applying LDA..." << std::endl;
 
+    TransformPipeline pipeline;
+    pipeline.add(new LDATransform(nbComponents));
+    apply_pipeline(pipeline);
 
-	/* --------------------- GENERATING CSV FILE OF PCA DIMENSIONS - QUICK N DIRTY -----------*/
-	//line 1: labels
-	//line 2: dimension 1
-	//line 3: dimension 2
-	std::ofstream csvFile;
-    csvFile.open("PCA_data.csv");
+    std::cout << "* LDA applied !" << std::endl << std::endl;
+}
+
+void Algorithm::applyPCA(int nbComponents) {
+    std::cout << "* Applying PCA..." << std::endl;
 
-	std::vector<int> classes;
-	std::vector<double> dimension1, dimension2;
-	i = 0;
+    /* Gram matrix when N < D, top components straight from the data otherwise */
+    TransformPipeline pipeline;
+    pipeline.add(new PCATransform(nbComponents));
+    apply_pipeline(pipeline);
+
+    std::cout << "* PCA applied !" << std::endl << std::endl;
+
+    generatePCACSV();
+}
+
+void Algorithm::generatePCACSV(std::string fileName) {
+    if (input_data->getVectorSize() < 2)
+	return;
+
+    /* --------------------- GENERATING CSV FILE OF PCA DIMENSIONS - QUICK N DIRTY -----------*/
+    //line 1: labels
+    //line 2: dimension 1
+    //line 3: dimension 2
+    std::ofstream csvFile;
+    csvFile.open(fileName);
+
+    std::vector<int> classes;
+    std::vector<double> dimension1, dimension2;
 
     for (auto const &training_class : input_data->getTrainingElements()) {
-		classes.push_back(training_class.first);
+	classes.push_back(training_class.first);
 
-		for (auto const &training_element : training_class.second) {
-			dimension1.push_back(training_element.data.row(0)[0]);
-			dimension2.push_back(training_element.data.row(1)[0]);
-			i++;
-		}
+	for (auto const &training_element : training_class.second) {
+	    dimension1.push_back(training_element.data(0));
+	    dimension2.push_back(training_element.data(1));
+	}
     }
 
-	i = 0;
-	for (auto const &testing_element : input_data->getTestingElements()) {
-		classes.push_back(testing_element.label);
-		dimension1.push_back(testing_element.data.row(0)[0]);
-		dimension2.push_back(testing_element.data.row(1)[0]);
-		i++;
-	}
+    for (auto const &testing_element : input_data->getTestingElements()) {
+	classes.push_back(testing_element.label);
+	dimension1.push_back(testing_element.data(0));
+	dimension2.push_back(testing_element.data(1));
+    }
 
-	for (auto const &label : classes)
-		csvFile  << label << ",";
+    for (auto const &label : classes)
+	csvFile << label << ",";
 
-	csvFile << "\n";
+    csvFile << "\n";
 
-	for (auto const &val : dimension1)
-		csvFile << val << ",";
+    for (auto const &val : dimension1)
+	csvFile << val << ",";
 
-	csvFile << "\n";
+    csvFile << "\n";
 
-	for (auto const &val : dimension2)
-		csvFile << val << ",";
+    for (auto const &val : dimension2)
+	csvFile << val << ",";
 
     csvFile.close();
+}
+
+/* NCC, NSC (2 sub-classes) and NN on the current data: {time, accuracy} of each */
+static std::vector<double> run_distance_classifiers(Algorithm &algorithm) {
+    std::vector<double> row;
+    row.push_back(algorithm.nearestClassCentroid());
+    row.push_back(algorithm.calculateAccuracy());
+    row.push_back(algorithm.nearestSubClassCentroid(2));
+    row.push_back(algorithm.calculateAccuracy());
+    row.push_back(algorithm.threadedNearestNeighbour());
+    row.push_back(algorithm.calculateAccuracy());
+
+    return row;
+}
+
+std::vector<std::vector<double> > Algorithm::benchmarkRandomProjection(const std::vector<int> &dimensions,
+	RandomProjection::Distribution distribution) {
+    std::vector<std::vector<double> > rows;
+
+    /* Reference: the raw data */
+    rows.push_back(run_distance_classifiers(*this));
+    rows.back().insert(rows.back().begin(), {double(input_data->getVectorSize()), 0});
+
+    for (int dimension : dimensions) {
+	TransformPipeline projection;
+	projection.add(new RandomProjection(dimension, distribution));
+
+	auto begin = std::chrono::steady_clock::now();
+	TransformedData *projected = projection.transform(input_data);
+	auto end = std::chrono::steady_clock::now();
+
+	Algorithm algorithm(projected);
+	rows.push_back(run_distance_classifiers(algorithm));
+	rows.back().insert(rows.back().begin(), {double(dimension), std::chrono::duration<double>(end - begin).count()});
+    }
+
+    /* Row: dimension, projection time, then {time, accuracy} of NCC, NSC and NN */
+    const char *names[] = {"NCC", "NSC", "NN"};
+    std::cout << "* Random projection: speedup / accuracy loss against the raw data" << std::endl;
+    for (auto const &row : rows) {
+	std::cout << "\t -> " << row[0] << " dimensions (projected in " << row[1] << "s):";
+	for (int c = 0; c < 3; c++)
+	    std::cout << " " << names[c] << " x" << rows[0][2 + 2 * c] / row[2 + 2 * c] << " / "
+		<< (rows[0][3 + 2 * c] - row[3 + 2 * c]) * 100 << "%";
+	std::cout << std::endl;
+    }
+    std::cout << std::endl;
+
+    return rows;
+}
+
+std::vector<double> Algorithm::benchmarkSymmetricRankUpdate() {
+    std::cout << "* Benchmarking X X^T..." << std::endl;
+
+    Eigen::MatrixXd samples;
+    Eigen::VectorXi classes;
+    build_training_matrix(samples, classes, false);
+
+    Eigen::MatrixXd dense(samples.rows(), samples.rows());
+    Eigen::MatrixXd serial = Eigen::MatrixXd::Zero(samples.rows(), samples.rows());
+    Eigen::MatrixXd parallel = Eigen::MatrixXd::Zero(samples.rows(), samples.rows());
+
+    auto t0 = std::chrono::steady_clock::now();
+    dense.noalias() = samples * samples.transpose();
+    auto t1 = std::chrono::steady_clock::now();
+    serial.selfadjointView<Eigen::Lower>().rankUpdate(samples);
+    auto t2 = std::chrono::steady_clock::now();
+    symmetricRankUpdate(parallel, samples);
+    auto t3 = std::chrono::steady_clock::now();
+
+    std::vector<double> times = {
+	std::chrono::duration<double>(t1 - t0).count(),
+	std::chrono::duration<double>(t2 - t1).count(),
+	std::chrono::duration<double>(t3 - t2).count()
+    };
+
+    double error = (parallel.triangularView<Eigen::Lower>().toDenseMatrix()
+	- dense.triangularView<Eigen::Lower>().toDenseMatrix()).norm() / dense.norm();
+
+    std::cout << "\t -> " << samples.rows() << "x" << samples.cols() << " samples, " << nbWorkerThreads() << " threads" << std::endl;
+    std::cout << "\t -> Dense product: " << times[0] << "s" << std::endl;
+    std::cout << "\t -> Serial rankUpdate: " << times[1] << "s" << std::endl;
+    std::cout << "\t -> Parallel rankUpdate: " << times[2] << "s (x" << times[0] / times[2]
+	<< " over the dense product, relative difference " << error << ")" << std::endl << std::endl;
+
+    return times;
+}
+
+std::vector<double> Algorithm::benchmarkPCA(int nbComponents) {
+    std::cout << "* Benchmarking PCA (" << nbComponents << " components)..." << std::endl;
+
+    Eigen::MatrixXd samples;
+    Eigen::VectorXi classes;
+    build_training_matrix(samples, classes, false);
+
+    auto begin = std::chrono::steady_clock::now();
+    ProjectionModel full = PCA::fitCovariance(samples, nbComponents);
+    auto middle = std::chrono::steady_clock::now();
+    ProjectionModel randomized = PCA::fitRandomized(samples, nbComponents);
+    auto end = std::chrono::steady_clock::now();
+
+    /* Incremental: only the tracked directions and one batch are held, never the training matrix */
+    TrainingSetStream stream(input_data);
+    IncrementalPCA incremental(samples.rows(), nbComponents);
+    incremental.update(stream, INCREMENTAL_PCA_BATCH_SIZE);
+    ProjectionModel incrementalModel = incremental.model();
+    auto last = std::chrono::steady_clock::now();
+
+    std::vector<double> times = {
+	std::chrono::duration<double>(middle - begin).count(),
+	std::chrono::duration<double>(end - middle).count(),
+	std::chrono::duration<double>(last - end).count()
+    };
+
+    if (samples.cols() < samples.rows()) {
+	ProjectionModel gram = PCA::fitGram(samples, nbComponents);
+	times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - last).count());
+	std::cout << "\t -> Gram matrix (N < D): " << times[3] << "s, subspace overlap "
+	    << (full.getBasis().transpose() * gram.getBasis()).squaredNorm() / full.getNbComponents() << std::endl;
+    }
+
+    /* Both bases are orthonormal: ||Q1^T Q2||^2 / k is 1 when they span the same subspace */
+    double overlap = (full.getBasis().transpose() * randomized.getBasis()).squaredNorm() / full.getNbComponents();
+
+    std::cout << "\t -> Full eigendecomposition: " << times[0] << "s" << std::endl;
+    std::cout << "\t -> Randomized: " << times[1] << "s (x" << times[0] / times[1] << ")" << std::endl;
+    std::cout << "\t -> Subspace overlap: " << overlap << ", leading variance " << full.getVariances()(0)
+	<< " vs " << randomized.getVariances()(0) << std::endl;
+    long held = (nbComponents + INCREMENTAL_PCA_EXTRA_COMPONENTS + INCREMENTAL_PCA_BATCH_SIZE) * samples.rows();
+    std::cout << "\t -> Incremental: " << times[2] << "s, subspace overlap "
+	<< (full.getBasis().transpose() * incrementalModel.getBasis()).squaredNorm() / full.getNbComponents()
+	<< ", " << held * sizeof(double) / 1048576.0 << " MB held instead of "
+	<< samples.size() * sizeof(double) / 1048576.0 << " MB" << std::endl << std::endl;
+
+    return times;
+}
+
+std::vector<double> Algorithm::benchmarkBinaryNearestNeighbour(int k) {
+    std::cout << "* Benchmarking binarized nearest neighbour (k = " << k << ")..." << std::endl << std::endl;
+    long nbQueries = input_data->getTestingElements().size();
+    std::vector<double> row;
+
+    auto begin = std::chrono::steady_clock::now();
+    blockedNearestNeighbour();
+    row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    row.push_back(calculateAccuracy());
+
+    BinaryData::Kernel kernels[] = {BinaryData::GENERIC, BinaryData::POPCNT, BinaryData::AVX2};
+    for (BinaryData::Kernel kernel : kernels) {
+	if (!BinaryData::isSupported(kernel))
+	    continue;
+
+	begin = std::chrono::steady_clock::now();
+	binaryNearestNeighbour(k, kernel);
+	row.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+	row.push_back(calculateAccuracy());
+    }
+
+    /* Row: {wall time, accuracy} of the exact double search, then of each supported kernel */
+    std::cout << "* Binarized nearest neighbour against doubles (" << input_data->getVectorSize() * sizeof(double)
+	<< " bytes per sample, " << (input_data->getVectorSize() + 63) / 64 * sizeof(uint64_t) << " binarized)" << std::endl;
+    std::cout << "\t -> Doubles: " << nbQueries / row[0] << " queries/s, " << row[1] * 100 << "%" << std::endl;
+    for (unsigned long i = 2, c = 0; i < row.size(); c++) {
+	if (!BinaryData::isSupported(kernels[c]))
+	    continue;
+	std::cout << "\t -> " << BinaryData::getName(kernels[c]) << ": " << nbQueries / row[i] << " queries/s (x"
+	    << row[0] / row[i] << "), " << row[i + 1] * 100 << "%" << std::endl;
+	i += 2;
+    }
+    std::cout << std::endl;
 
+    return row;
 }
@@ -11,34 +11,124 @@
 #include "../DataInput/DataInput.h"
 #include "../DataInput/ORLData.h"
 #include "../DataInput/MNISTData.h"
+#include "../DataInput/TransformedData.h"
+#include "Transform.h"
+#include "CentroidSet.h"
+#include "NormalEquations.h"
+#include "LeastSquares.h"
+#include "PCA.h"
+#include "IncrementalPCA.h"
+#include "RandomProjection.h"
+#include "SparseData.h"
+#include "BinaryData.h"
+#include "ImagePyramid.h"
+#include "MixedPrecision.h"
+#include "Metric.h"
 
 #define KMEANS_MAX_DISTANCE 1 //Max distance allowed between two iterations of the same mean vector
 #define LEARNING_RATE 0.1
+#define MSE_REGULARIZATION 0.001 //lambda of the MSE perceptrons: (X X^T + lambda I) W = X Y^T
+#define SGD_BATCH_SIZE 64 //Default mini-batch size of the SGD perceptron trainer
+#define SGD_MAX_EPOCHS 50 //Passes over the training data of the SGD perceptron trainer
+#define SOFTMAX_LAMBDA 0.0001 //Default L2 regularization of the softmax regression
+#define SOFTMAX_PATIENCE 5 //Iterations without validation improvement before stopping
+#define SOFTMAX_LEARNING_RATE 0.01 //Step of the first order optimizers on the softmax regression
+#define SOFTMAX_MOMENTUM 0.9
+#define CENTROIDS_COMPENSATED_THRESHOLD 1000000 //Use compensated summation for the class means above this many samples
 
 class Algorithm {
 
 	private:
 		DataInput *input_data;
-		Eigen::VectorXd training_data_mean_vector;
-		Eigen::MatrixXd training_data_eigen_vectors;
 
+		/* Replace the data by its projection: training holds the training elements, one per column */
+		void apply_projection(const ProjectionModel &model, const Eigen::MatrixXd &training);
+		void apply_pipeline(TransformPipeline &pipeline); /* Replace the data by its transform */
+		void classify_centroids(const CentroidSet &centroids, bool hierarchical);
+		template <typename Metric> void classify_metric_centroids(const CentroidSet &centroids);
+		CentroidSet fit_sub_class_centroids(int nbSubClasses); /* K-means within each class */
+		void build_training_matrix(Eigen::MatrixXd &samples, Eigen::VectorXi &classes, bool augment);
+		void build_testing_matrix(Eigen::MatrixXd &samples, Eigen::VectorXi &classes);
 		void train_perceptrons_MSE(Eigen::MatrixXd &weights);
-		void train_perceptrons_BPG(Eigen::MatrixXd &weights);
+		void init_perceptron_weights(Eigen::MatrixXd &weights);
+		/* The training matrix, built either in dense or in sparse (if sparse enough): the other one stays empty */
+		SampleMatrix select_storage(Eigen::MatrixXd &dense, SparseSamples &sparse, Eigen::VectorXi &classes, bool augment);
+		double training_accuracy(const Eigen::Ref<const Eigen::MatrixXd> &weights, const SampleMatrix &samples,
+			const Eigen::VectorXi &classes);
+		/* Both trainers stop early once targetAccuracy (0 = disabled) is reached on the training set,
+		 * by argmax over all classes. With a target, they return the training accuracy of the final
+		 * weights, which is below it if they stopped at their cap (0 otherwise) */
+		double train_perceptrons_BPG(Eigen::MatrixXd &weights, double targetAccuracy = 0);
+		/* Throws std::invalid_argument if batchSize is not positive */
+		double train_perceptrons_SGD(Eigen::MatrixXd &weights, int batchSize, double targetAccuracy = 0,
+			unsigned int nbThreads = 0);
+		void train_softmax(Eigen::MatrixXd &weights, double lambda);
 		void classify_perceptrons_MSE(Eigen::MatrixXd weights);
-		void classify_perceptrons_BPG(Eigen::MatrixXd weights);
+		void classify_argmax(const Eigen::MatrixXd &weights); /* Augmented weights, highest output wins */
 
 	public:
 		Algorithm(MNISTData *data);
 		Algorithm(ORLData *data);
+		Algorithm(TransformedData *data);
 		~Algorithm();
 
-		void applyPCA(); /* Generate 2D data based on the input_data */
-		double nearestClassCentroid();
-		double nearestSubClassCentroid(int nbSubClasses);
+		void applyPCA(int nbComponents = PCA_COMPONENTS); /* Project the input_data on its top principal components */
+		/* Labels and first two dimensions of every element (training, then testing), to plot the PCA in Matlab */
+		void generatePCACSV(std::string fileName = "PCA_data.csv");
+		/* Same, fitted batch by batch: from the loaded training set as a pipeline step, or from a file
+		 * written by BinaryFileStream::write if a path is given, the fit then never holding the training matrix */
+		void applyIncrementalPCA(int nbComponents = PCA_COMPONENTS, long batchSize = INCREMENTAL_PCA_BATCH_SIZE,
+			std::string path = "");
+		/* NCC, NSC and NN on the raw data, then on random projections of it to each dimension;
+		 * one row per run: dimension, projection time, then time and accuracy of each classifier */
+		std::vector<std::vector<double> > benchmarkRandomProjection(const std::vector<int> &dimensions,
+			RandomProjection::Distribution distribution = RandomProjection::GAUSSIAN);
+		std::vector<double> benchmarkSymmetricRankUpdate(); /* Wall time of X X^T: dense product, serial and parallel SYRK */
+		void applyLDA(int nbComponents = 0); /* Project the input_data on its (at most C - 1) Fisher discriminant directions */
+		/* Wall time of the full, randomized, incremental (from a TrainingSetStream) and (N < D) Gram PCA */
+		std::vector<double> benchmarkPCA(int nbComponents);
+		double nearestClassCentroid(bool hierarchical = false); /* hierarchical: search the centroids through a CentroidTree */
+		double onlineNearestClassCentroid(int batchSize); /* Same as NCC, fed to an incremental model in mini-batches */
+		double nearestSubClassCentroid(int nbSubClasses, bool hierarchical = false);
 		double nearestNeighbour();
 		double threadedNearestNeighbour();
+		double blockedNearestNeighbour(); /* Distances by blocks of products, sparse or dense depending on the density; exact */
+		/* NN, NCC and NSC under a metric of Metric.h, e.g. metricNearestNeighbour<CosineMetric>(). Instantiated
+		 * in Algorithm.cpp for the Euclidean, cosine, Mahalanobis, L1 and L-infinity metrics. NSC finds its
+		 * sub classes by Euclidean K-means and has no CentroidTree search, which is Euclidean only */
+		template <typename Metric> double metricNearestNeighbour();
+		template <typename Metric> double metricNearestClassCentroid();
+		template <typename Metric> double metricNearestSubClassCentroid(int nbSubClasses);
+		/* Exact NN, pruning the samples with the lower bounds of 2x2, 4x4... pooled images first */
+		double pyramidNearestNeighbour(int nbLevels = PYRAMID_LEVELS);
+		/* Exact NN: float scores for every sample, double distances for a shortlist of the best ones */
+		double mixedPrecisionNearestNeighbour(int shortlist = MIXED_PRECISION_SHORTLIST);
+		/* k-NN on the images binarized like mnist::binarize_each, by popcount Hamming distance */
+		double binaryNearestNeighbour(int k = 1, BinaryData::Kernel kernel = BinaryData::AUTO);
+		/* Wall time and accuracy of the blocked double NN, then of binaryNearestNeighbour with every supported kernel */
+		std::vector<double> benchmarkBinaryNearestNeighbour(int k = 1);
 		double perceptronBPG(); //Back-propagation
+		double perceptronSGD(int batchSize = SGD_BATCH_SIZE); //Mini-batch stochastic gradient, multithreaded
 		double perceptronMSE(); //Minimal Square Error
+		/* Validation accuracy (argmax rule) of the MSE perceptrons for every lambda, from a single
+		 * eigendecomposition on the rest of the training set; the test set ends up classified with the
+		 * best one. Every 10th training element is held out for validation */
+		std::vector<double> perceptronMSEPath(const std::vector<double> &lambdas);
+		/* Same, accumulating the normal equations chunk by chunk from the loaded training set,
+		 * or from a file written by BinaryFileStream::write if a path is given */
+		double perceptronMSEStreaming(long chunkSize = NORMAL_EQUATIONS_CHUNK_SIZE, std::string path = "");
+		/* Same, by preconditioned conjugate gradient on X X^T + lambda I without ever forming it */
+		double perceptronMSEConjugateGradient(double tolerance = MSE_CG_TOLERANCE, int maxIterations = MSE_CG_MAX_ITERATIONS);
+		double softmaxRegression(double lambda = SOFTMAX_LAMBDA); //Multinomial logistic regression, L-BFGS
+		/* Wall time of BPG and SGD to reach targetAccuracy, each followed by the training accuracy it
+		 * ended with: a time only counts if that accuracy is at least targetAccuracy. Then the softmax
+		 * regression trained by gradient descent (plain, momentum, Nesterov), Adam and L-BFGS, each
+		 * as {wall time, training accuracy, passes over the training set} */
+		std::vector<double> benchmarkPerceptronTrainers(double targetAccuracy, int batchSize = SGD_BATCH_SIZE);
+		/* Wall time and test accuracy of the MSE perceptrons solved by Cholesky, by conjugate gradient,
+		 * over a whole regularization path (perceptronMSEPath), then streamed from the training set
+		 * written to path by BinaryFileStream::write (deleted afterwards) */
+		std::vector<double> benchmarkMSESolvers(const std::vector<double> &lambdas, std::string path = "training_samples.bin");
 		static void generateCSV(std::string fileName, std::vector<std::vector<double> > rows); /* Generate a CSV file to plot it in Matlab */
 		double calculateAccuracy();
 };
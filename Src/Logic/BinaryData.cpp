@@ -0,0 +1,201 @@
+/*
+ * BinaryData.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "BinaryData.h"
+#include "Parallel.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <numeric>
+
+BinarySamples::BinarySamples(long nbBits) : mNbSamples(0), mNbBits(nbBits), mNbWords((nbBits + 63) / 64) {
+}
+
+void BinarySamples::reserve(long nbSamples) {
+    mWords.reserve((nbSamples + BINARY_GROUP_SIZE - 1) / BINARY_GROUP_SIZE * mNbWords * BINARY_GROUP_SIZE);
+}
+
+void BinarySamples::add(const Eigen::VectorXd &sample, double threshold) {
+    if (mNbSamples % BINARY_GROUP_SIZE == 0)
+	mWords.resize(mWords.size() + mNbWords * BINARY_GROUP_SIZE, 0);
+
+    uint64_t *group = &mWords[mNbSamples / BINARY_GROUP_SIZE * mNbWords * BINARY_GROUP_SIZE];
+    long lane = mNbSamples % BINARY_GROUP_SIZE;
+    for (long d = 0; d < mNbBits; d++)
+	if (sample(d) > threshold)
+	    group[d / 64 * BINARY_GROUP_SIZE + lane] |= uint64_t(1) << (d % 64);
+
+    mNbSamples++;
+}
+
+void BinaryData::training(DataInput *data, BinarySamples &samples, std::vector<int> &labels, double threshold) {
+    samples = BinarySamples(data->getVectorSize());
+    samples.reserve(data->getNbTrainingElements());
+    labels.clear();
+
+    for (auto const &training_class : data->getTrainingElements()) {
+	for (auto const &training_element : training_class.second) {
+	    samples.add(training_element.data, threshold);
+	    labels.push_back(training_class.first);
+	}
+    }
+}
+
+void BinaryData::testing(DataInput *data, BinarySamples &samples, double threshold) {
+    samples = BinarySamples(data->getVectorSize());
+    samples.reserve(data->getTestingElements().size());
+
+    for (auto const &testing_element : data->getTestingElements())
+	samples.add(testing_element.data, threshold);
+}
+
+/* Portable bit counting (SWAR): sums of 2, 4, then 8 bits, added up by the multiplication */
+static void distances_generic(const uint64_t *query, const BinarySamples &samples, uint32_t *distances) {
+    long nbWords = samples.getNbWords();
+
+    for (long g = 0; g < samples.getNbGroups(); g++) {
+	const uint64_t *group = samples.getGroup(g);
+	for (int lane = 0; lane < BINARY_GROUP_SIZE; lane++) {
+	    uint32_t count = 0;
+	    for (long w = 0; w < nbWords; w++) {
+		uint64_t x = query[w] ^ group[w * BINARY_GROUP_SIZE + lane];
+		x -= (x >> 1) & 0x5555555555555555ULL;
+		x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+		x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+		count += (x * 0x0101010101010101ULL) >> 56;
+	    }
+	    distances[g * BINARY_GROUP_SIZE + lane] = count;
+	}
+    }
+}
+
+__attribute__((target("popcnt")))
+static void distances_popcnt(const uint64_t *query, const BinarySamples &samples, uint32_t *distances) {
+    long nbWords = samples.getNbWords();
+
+    for (long g = 0; g < samples.getNbGroups(); g++) {
+	const uint64_t *group = samples.getGroup(g);
+	uint64_t counts[BINARY_GROUP_SIZE] = {0};
+	for (long w = 0; w < nbWords; w++)
+	    for (int lane = 0; lane < BINARY_GROUP_SIZE; lane++)
+		counts[lane] += _mm_popcnt_u64(query[w] ^ group[w * BINARY_GROUP_SIZE + lane]);
+
+	for (int lane = 0; lane < BINARY_GROUP_SIZE; lane++)
+	    distances[g * BINARY_GROUP_SIZE + lane] = counts[lane];
+    }
+}
+
+/* One group per iteration: the query word is broadcast against the same word of the
+ * 4 samples, the bytes counted with a nibble lookup table (vpshufb). The byte counts
+ * are summed in place and only widened (vpsadbw) every 31 words, before they could
+ * overflow, which directly yields the 4 distances in the 4 lanes */
+__attribute__((target("avx2")))
+static void distances_avx2(const uint64_t *query, const BinarySamples &samples, uint32_t *distances) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+	    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    long nbWords = samples.getNbWords();
+
+    for (long g = 0; g < samples.getNbGroups(); g++) {
+	const uint64_t *group = samples.getGroup(g);
+	__m256i sums = zero;
+
+	for (long from = 0; from < nbWords; from += 31) {
+	    __m256i bytes = zero;
+	    for (long w = from; w < std::min(nbWords, from + 31); w++) {
+		__m256i x = _mm256_xor_si256(_mm256_set1_epi64x(query[w]),
+			_mm256_loadu_si256((const __m256i *) (group + w * BINARY_GROUP_SIZE)));
+		__m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, nibble));
+		__m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+		bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(low, high));
+	    }
+	    sums = _mm256_add_epi64(sums, _mm256_sad_epu8(bytes, zero));
+	}
+
+	alignas(32) uint64_t counts[BINARY_GROUP_SIZE];
+	_mm256_store_si256((__m256i *) counts, sums);
+	for (int lane = 0; lane < BINARY_GROUP_SIZE; lane++)
+	    distances[g * BINARY_GROUP_SIZE + lane] = counts[lane];
+    }
+}
+
+bool BinaryData::isSupported(Kernel kernel) {
+    __builtin_cpu_init();
+    switch (kernel) {
+	case POPCNT:
+	    return __builtin_cpu_supports("popcnt");
+	case AVX2:
+	    return __builtin_cpu_supports("avx2");
+	default:
+	    return true;
+    }
+}
+
+BinaryData::Kernel BinaryData::bestKernel() {
+    static const Kernel best = isSupported(AVX2) ? AVX2 : isSupported(POPCNT) ? POPCNT : GENERIC;
+    return best;
+}
+
+const char *BinaryData::getName(Kernel kernel) {
+    const char *names[] = {"auto", "generic", "popcnt", "avx2"};
+    return names[kernel];
+}
+
+void BinaryData::distances(const uint64_t *query, const BinarySamples &samples, uint32_t *distances, Kernel kernel) {
+    switch (kernel == AUTO ? bestKernel() : kernel) {
+	case AVX2:
+	    distances_avx2(query, samples, distances);
+	    break;
+	case POPCNT:
+	    distances_popcnt(query, samples, distances);
+	    break;
+	default:
+	    distances_generic(query, samples, distances);
+    }
+}
+
+void BinaryData::classify(const BinarySamples &samples, const std::vector<int> &labels,
+	const BinarySamples &queries, int k, std::vector<int> &predicted, Kernel kernel) {
+    k = std::max(1, std::min<int>(k, samples.size()));
+    predicted.resize(queries.size());
+
+    parallelFor(queries.size(), [&](long q) {
+	std::vector<uint64_t> query(queries.getNbWords());
+	for (long w = 0; w < queries.getNbWords(); w++)
+	    query[w] = queries.getWord(q, w);
+
+	std::vector<uint32_t> distance(samples.getNbGroups() * BINARY_GROUP_SIZE);
+	BinaryData::distances(query.data(), samples, distance.data(), kernel);
+
+	if (k == 1) {
+	    predicted[q] = labels[std::min_element(distance.begin(), distance.begin() + samples.size()) - distance.begin()];
+	    return;
+	}
+
+	/* The k nearest, ordered by distance then index */
+	std::vector<long> nearest(samples.size());
+	std::iota(nearest.begin(), nearest.end(), 0);
+	std::partial_sort(nearest.begin(), nearest.begin() + k, nearest.end(), [&](long a, long b) {
+	    return distance[a] < distance[b] || (distance[a] == distance[b] && a < b);
+	});
+
+	std::vector<std::pair<int, int> > votes; //Label, number of votes
+	for (int i = 0; i < k; i++) {
+	    auto vote = std::find_if(votes.begin(), votes.end(), [&](const std::pair<int, int> &v) {
+		return v.first == labels[nearest[i]];
+	    });
+	    if (vote == votes.end())
+		votes.push_back(std::make_pair(labels[nearest[i]], 1));
+	    else
+		vote->second++;
+	}
+
+	/* votes is in order of first appearance: the first maximum is the nearest voter's class */
+	predicted[q] = std::max_element(votes.begin(), votes.end(), [](const std::pair<int, int> &a,
+		const std::pair<int, int> &b) { return a.second < b.second; })->first;
+    });
+}
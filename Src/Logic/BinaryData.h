@@ -0,0 +1,78 @@
+/*
+ * BinaryData.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Binarized images packed one bit per pixel into 64-bit words (13 words for a
+ * 28x28 MNIST digit, 64 times less memory than doubles), and nearest neighbour
+ * search on them by Hamming distance: popcount(a XOR b). The distance kernels
+ * come in a portable, a POPCNT and an AVX2 version, picked at run time.
+ */
+
+#ifndef BINARYDATA_H
+#define BINARYDATA_H
+
+#include <vector>
+#include <cstdint>
+#include "../Eigen/Core"
+#include "../DataInput/DataInput.h"
+
+#define BINARY_THRESHOLD (30.0 / 255) //Threshold of mnist::binarize_each, on pixels rescaled to [0, 1]
+#define BINARY_GROUP_SIZE 4 //Samples interleaved word by word, one per 64-bit lane of an AVX2 register
+
+/* Packed samples, stored by groups of BINARY_GROUP_SIZE: word w of sample i is
+ * at group i / 4, row w, lane i % 4. The last group is padded with zeros */
+class BinarySamples {
+
+	private:
+		std::vector<uint64_t> mWords;
+		long mNbSamples;
+		long mNbBits;
+		long mNbWords;
+
+	public:
+		explicit BinarySamples(long nbBits = 0);
+
+		/* Pixel d becomes bit d: 1 if it is above threshold */
+		void add(const Eigen::VectorXd &sample, double threshold = BINARY_THRESHOLD);
+		void reserve(long nbSamples);
+
+		uint64_t getWord(long i, long w) const {
+			return mWords[(i / BINARY_GROUP_SIZE * mNbWords + w) * BINARY_GROUP_SIZE + i % BINARY_GROUP_SIZE];
+		}
+		const uint64_t *getGroup(long g) const { return &mWords[g * mNbWords * BINARY_GROUP_SIZE]; }
+		long size() const { return mNbSamples; }
+		long getNbGroups() const { return (mNbSamples + BINARY_GROUP_SIZE - 1) / BINARY_GROUP_SIZE; }
+		long getNbBits() const { return mNbBits; }
+		long getNbWords() const { return mNbWords; }
+		long getMemory() const { return mWords.size() * sizeof(uint64_t); } //Bytes
+};
+
+class BinaryData {
+
+	public:
+		enum Kernel { AUTO, GENERIC, POPCNT, AVX2 };
+
+		/* Fastest kernel the processor supports */
+		static Kernel bestKernel();
+		static bool isSupported(Kernel kernel);
+		static const char *getName(Kernel kernel);
+
+		/* labels holds the label of every training sample, in the order of the training map */
+		static void training(DataInput *data, BinarySamples &samples, std::vector<int> &labels,
+			double threshold = BINARY_THRESHOLD);
+		static void testing(DataInput *data, BinarySamples &samples, double threshold = BINARY_THRESHOLD);
+
+		/* distances[i] = Hamming distance between the query (getNbWords() words) and sample i.
+		 * distances must hold getNbGroups() * BINARY_GROUP_SIZE entries */
+		static void distances(const uint64_t *query, const BinarySamples &samples, uint32_t *distances,
+			Kernel kernel = AUTO);
+
+		/* Class of every query: vote of its k nearest samples, a tie going to the class
+		 * of the nearest voter. With k == 1, the first sample at the lowest distance */
+		static void classify(const BinarySamples &samples, const std::vector<int> &labels,
+			const BinarySamples &queries, int k, std::vector<int> &predicted, Kernel kernel = AUTO);
+};
+
+#endif
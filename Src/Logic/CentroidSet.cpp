@@ -0,0 +1,119 @@
+/*
+ * CentroidSet.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "CentroidSet.h"
+#include "Parallel.h"
+#include <algorithm>
+
+CentroidSet::CentroidSet(const Eigen::MatrixXd &centroids, const std::vector<int> &labels) {
+    set(centroids, labels);
+}
+
+CentroidSet CentroidSet::fit(const std::map<int, std::vector<DataInput::Element> > &training,
+	bool compensated, unsigned int nbThreads) {
+    struct Chunk {
+	const std::vector<DataInput::Element> *elements;
+	unsigned long from, to;
+    };
+
+    /* Split every class into chunks: the chunk boundaries only depend on the data */
+    std::vector<Chunk> chunks;
+    std::vector<unsigned long> first_chunk; //Index of the first chunk of each class
+    std::vector<int> labels;
+    long size = 0;
+    for (auto const& training_class : training) {
+	first_chunk.push_back(chunks.size());
+	labels.push_back(training_class.first);
+	size = training_class.second.empty() ? size : training_class.second.front().data.size();
+
+	for (unsigned long from = 0; from < training_class.second.size(); from += CENTROIDS_CHUNK_SIZE)
+	    chunks.push_back({&training_class.second, from,
+		    std::min<unsigned long>(from + CENTROIDS_CHUNK_SIZE, training_class.second.size())});
+    }
+    first_chunk.push_back(chunks.size());
+
+    /* Sum each chunk into its own accumulator */
+    std::vector<Eigen::VectorXd> partial_sums(chunks.size());
+    parallelFor(chunks.size(), [&](long i) {
+	Eigen::VectorXd &sum = partial_sums[i];
+	sum.setZero(size);
+
+	if (compensated) {
+	    Eigen::VectorXd compensation(Eigen::VectorXd::Zero(size)), y(size), t(size);
+	    for (unsigned long k = chunks[i].from; k < chunks[i].to; k++) {
+		y = chunks[i].elements->at(k).data - compensation;
+		t = sum + y;
+		compensation = (t - sum) - y;
+		sum = t;
+	    }
+	} else {
+	    for (unsigned long k = chunks[i].from; k < chunks[i].to; k++)
+		sum += chunks[i].elements->at(k).data;
+	}
+    }, nbThreads);
+
+    /* Merge the partial sums of each class as a balanced binary tree */
+    Eigen::MatrixXd centroids(Eigen::MatrixXd::Zero(labels.size(), size));
+    for (unsigned long c = 0; c < labels.size(); c++) {
+	unsigned long from = first_chunk[c], count = first_chunk[c + 1] - from;
+	if (!count)
+	    continue;
+
+	for (unsigned long stride = 1; stride < count; stride *= 2)
+	    for (unsigned long k = 0; k + stride < count; k += 2 * stride)
+		partial_sums[from + k] += partial_sums[from + k + stride];
+
+	centroids.row(c) = partial_sums[from].transpose() / training.at(labels[c]).size();
+    }
+
+    return CentroidSet(centroids, labels);
+}
+
+void CentroidSet::set(const Eigen::MatrixXd &centroids, const std::vector<int> &labels) {
+    mCentroids = centroids;
+    mLabels = labels;
+    mSquaredNorms = mCentroids.rowwise().squaredNorm();
+}
+
+/* ||x - c||^2 = ||x||^2 + ||c||^2 - 2 c.x: ||x||^2 is the same for every centroid
+ * so it does not change the argmin, and the dot products of a block of samples
+ * against all centroids come out of a single matrix product */
+void CentroidSet::classify(const Eigen::Ref<const Eigen::MatrixXd> &samples, std::vector<int> &classes) const {
+    classes.resize(samples.cols());
+    Eigen::MatrixXd distances;
+
+    for (long from = 0; from < samples.cols(); from += CENTROIDS_BLOCK_SIZE) {
+	long count = std::min<long>(CENTROIDS_BLOCK_SIZE, samples.cols() - from);
+
+	distances.noalias() = mCentroids * samples.middleCols(from, count);
+	distances = (-2 * distances).colwise() + mSquaredNorms;
+
+	for (long j = 0; j < count; j++) {
+	    Eigen::Index optimum;
+	    distances.col(j).minCoeff(&optimum);
+	    classes[from + j] = mLabels[optimum];
+	}
+    }
+}
+
+void CentroidSet::classify(std::vector<DataInput::Element> &elements) const {
+    Eigen::MatrixXd block(mCentroids.cols(), CENTROIDS_BLOCK_SIZE);
+    std::vector<int> classes;
+
+    /* Gather the elements block by block instead of copying the whole test set */
+    for (unsigned long from = 0; from < elements.size(); from += CENTROIDS_BLOCK_SIZE) {
+	long count = std::min<unsigned long>(CENTROIDS_BLOCK_SIZE, elements.size() - from);
+
+	for (long j = 0; j < count; j++)
+	    block.col(j) = elements[from + j].data;
+
+	classify(block.leftCols(count), classes);
+
+	for (long j = 0; j < count; j++)
+	    elements[from + j].given_class = classes[j];
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * CentroidSet.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Dense set of class centroids, stored as one C x D matrix (one centroid
+ * per row) along with their squared norms, so that a whole batch of
+ * samples can be classified with one matrix product.
+ */
+
+#ifndef CENTROIDSET_H
+#define CENTROIDSET_H
+
+#include <map>
+#include <vector>
+#include "../DataInput/DataInput.h"
+
+#define CENTROIDS_BLOCK_SIZE 1024 //Number of samples classified per matrix product
+#define CENTROIDS_CHUNK_SIZE 256 //Number of training samples summed per partial sum
+
+class CentroidSet {
+
+	private:
+		Eigen::MatrixXd mCentroids; //C x D, one centroid per row
+		Eigen::VectorXd mSquaredNorms; //||c||^2 for each centroid
+		std::vector<int> mLabels; //Class of each centroid
+
+	public:
+		CentroidSet() {}
+		CentroidSet(const Eigen::MatrixXd &centroids, const std::vector<int> &labels);
+
+		/* Build the mean vector of each class of the training set. Samples are
+		 * summed in fixed-size chunks spread over nbThreads threads (0 = all cores),
+		 * then the partial sums of each class are merged pairwise in a fixed order,
+		 * so the result does not depend on the number of threads. With compensated
+		 * set, each chunk is summed with Kahan summation. */
+		static CentroidSet fit(const std::map<int, std::vector<DataInput::Element> > &training,
+			bool compensated = false, unsigned int nbThreads = 0);
+
+		/* Replace the centroids and refresh the cached norms */
+		void set(const Eigen::MatrixXd &centroids, const std::vector<int> &labels);
+
+		/* Classify each column of samples (D x N) to the class of its nearest centroid */
+		void classify(const Eigen::Ref<const Eigen::MatrixXd> &samples, std::vector<int> &classes) const;
+		/* Same, reading the elements' data and setting their given_class */
+		void classify(std::vector<DataInput::Element> &elements) const;
+
+		const Eigen::MatrixXd &getCentroids() const { return mCentroids; }
+		const Eigen::VectorXd &getSquaredNorms() const { return mSquaredNorms; }
+		const std::vector<int> &getLabels() const { return mLabels; }
+		int size() const { return mCentroids.rows(); }
+};
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ * CentroidTree.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "CentroidTree.h"
+#include "Parallel.h"
+#include <queue>
+#include <limits>
+#include <numeric>
+#include <functional>
+
+CentroidTree::CentroidTree(const CentroidSet &centroids, int branching, int leafSize) {
+    mBranching = std::max(2, branching);
+    mLeafSize = std::max(1, leafSize);
+
+    std::vector<long> indices(centroids.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    build(indices, 0, indices.size(), centroids.getCentroids());
+
+    /* Store the centroids in tree order so that every node covers a block of rows */
+    mCentroids.resize(centroids.size(), centroids.getCentroids().cols());
+    for (unsigned long i = 0; i < indices.size(); i++) {
+	mCentroids.row(i) = centroids.getCentroids().row(indices[i]);
+	mLabels.push_back(centroids.getLabels()[indices[i]]);
+    }
+}
+
+int CentroidTree::build(std::vector<long> &indices, long from, long to, const Eigen::MatrixXd &centroids) {
+    int node = mNodes.size();
+    mNodes.push_back(Node());
+    mNodes[node].from = from;
+    mNodes[node].to = to;
+    mNodes[node].center.setZero(centroids.cols());
+    mNodes[node].radius = 0;
+
+    if (from == to)
+	return node;
+
+    for (long i = from; i < to; i++)
+	mNodes[node].center += centroids.row(indices[i]).transpose();
+    mNodes[node].center /= to - from;
+
+    for (long i = from; i < to; i++)
+	mNodes[node].radius = std::max(mNodes[node].radius,
+		(centroids.row(indices[i]).transpose() - mNodes[node].center).norm());
+
+    if (to - from <= mLeafSize)
+	return node;
+
+    std::vector<long> boundaries;
+    split(indices, from, to, centroids, boundaries);
+
+    for (unsigned long k = 0; k + 1 < boundaries.size(); k++) {
+	if (boundaries[k] == boundaries[k + 1])
+	    continue;
+
+	int child = build(indices, boundaries[k], boundaries[k + 1], centroids);
+	mNodes[node].children.push_back(child);
+    }
+
+    return node;
+}
+
+/* Balanced k-means on indices[from, to): every cluster holds at most ceil(n / k)
+ * centroids, points with the most to lose being assigned first. On return the
+ * segment is reordered by cluster and boundaries holds the k + 1 cluster limits */
+void CentroidTree::split(std::vector<long> &indices, long from, long to, const Eigen::MatrixXd &centroids,
+	std::vector<long> &boundaries) const {
+    long n = to - from;
+    int k = std::min<long>(mBranching, n);
+    long capacity = (n + k - 1) / k;
+
+    Eigen::MatrixXd points(n, centroids.cols());
+    for (long i = 0; i < n; i++)
+	points.row(i) = centroids.row(indices[from + i]);
+
+    /* Deterministic initialization: the point closest to the mean, then each time the point
+     * farthest from every center chosen so far. Starting from the middle rather than from an
+     * outlier spreads the other centers around it */
+    Eigen::MatrixXd centers(k, points.cols());
+    Eigen::VectorXd closest = (points.rowwise() - points.colwise().mean()).rowwise().squaredNorm();
+    Eigen::Index seed;
+    closest.minCoeff(&seed);
+    closest.setConstant(std::numeric_limits<double>::infinity());
+    for (int c = 0; c < k; c++) {
+	centers.row(c) = points.row(seed);
+	closest = closest.cwiseMin((points.rowwise() - centers.row(c)).rowwise().squaredNorm());
+	closest.maxCoeff(&seed);
+    }
+
+    std::vector<int> assignment(n);
+    std::vector<long> order(n), sizes(k);
+    Eigen::MatrixXd distances(n, k);
+    Eigen::VectorXd regret(n);
+
+    for (int iteration = 0; iteration < CENTROID_TREE_KMEANS_ITERATIONS; iteration++) {
+	for (int c = 0; c < k; c++)
+	    distances.col(c) = (points.rowwise() - centers.row(c)).rowwise().squaredNorm();
+
+	/* Regret: how much farther the second best center is than the best one */
+	for (long i = 0; i < n; i++) {
+	    Eigen::VectorXd row = distances.row(i).transpose();
+	    std::sort(row.data(), row.data() + k);
+	    regret(i) = row(1) - row(0);
+	}
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](long a, long b) { return regret(a) > regret(b); });
+
+	std::fill(sizes.begin(), sizes.end(), 0);
+	bool changed = false;
+	for (long i : order) {
+	    int best = -1;
+	    for (int c = 0; c < k; c++)
+		if (sizes[c] < capacity && (best == -1 || distances(i, c) < distances(i, best)))
+		    best = c;
+
+	    changed |= iteration == 0 || assignment[i] != best;
+	    assignment[i] = best;
+	    sizes[best]++;
+	}
+
+	if (!changed)
+	    break;
+
+	centers.setZero();
+	for (long i = 0; i < n; i++)
+	    centers.row(assignment[i]) += points.row(i);
+	for (int c = 0; c < k; c++)
+	    if (sizes[c])
+		centers.row(c) /= sizes[c];
+    }
+
+    /* Reorder the segment cluster by cluster */
+    std::vector<long> segment(indices.begin() + from, indices.begin() + to);
+    boundaries.assign(1, from);
+    long position = from;
+    for (int c = 0; c < k; c++) {
+	for (long i = 0; i < n; i++)
+	    if (assignment[i] == c)
+		indices[position++] = segment[i];
+
+	boundaries.push_back(position);
+    }
+}
+
+long CentroidTree::nearest(const Eigen::VectorXd &sample, long maxChecks) const {
+    typedef std::pair<double, int> Entry; //Lower bound of the squared distance, node
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    double best = std::numeric_limits<double>::infinity();
+    long bestIndex = -1, checks = 0;
+
+    queue.push(Entry(0, 0));
+    while (!queue.empty()) {
+	Entry entry = queue.top();
+	queue.pop();
+
+	/* Every centroid left in the queue is at least this far: nothing can beat best */
+	if (entry.first >= best)
+	    break;
+
+	const Node &node = mNodes[entry.second];
+	if (node.children.empty()) {
+	    long count = node.to - node.from;
+	    Eigen::Index optimum;
+	    double distance = (mCentroids.middleRows(node.from, count).rowwise() - sample.transpose())
+		.rowwise().squaredNorm().minCoeff(&optimum);
+
+	    if (distance < best) {
+		best = distance;
+		bestIndex = node.from + optimum;
+	    }
+
+	    checks += count;
+	    if (maxChecks && checks >= maxChecks)
+		break;
+	} else {
+	    for (int child : node.children) {
+		double bound = std::max(0.0, (sample - mNodes[child].center).norm() - mNodes[child].radius);
+		queue.push(Entry(bound * bound, child));
+	    }
+	}
+    }
+
+    return bestIndex;
+}
+
+int CentroidTree::classify(const Eigen::VectorXd &sample, long maxChecks) const {
+    return mLabels[nearest(sample, maxChecks)];
+}
+
+void CentroidTree::classify(std::vector<DataInput::Element> &elements, long maxChecks) const {
+    parallelFor(elements.size(), [&](long i) {
+	elements[i].given_class = classify(elements[i].data, maxChecks);
+    });
+}
+
+int CentroidTree::getDepth() const {
+    std::function<int(int)> depth = [&](int node) {
+	int deepest = 0;
+	for (int child : mNodes[node].children)
+	    deepest = std::max(deepest, depth(child));
+
+	return deepest + 1;
+    };
+
+    return depth(0);
+}
@@ -0,0 +1,56 @@
+/*
+ * CentroidTree.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Hierarchical index over a set of centroids: a balanced k-means tree whose
+ * nodes keep a center and a covering radius. A query walks the tree best-bin
+ * first, ordered by the lower bound max(0, ||x - center|| - radius) of each
+ * node, so whole branches of centroids are skipped.
+ */
+
+#ifndef CENTROIDTREE_H
+#define CENTROIDTREE_H
+
+#include "CentroidSet.h"
+
+#define CENTROID_TREE_BRANCHING 4 //Number of children of each inner node
+#define CENTROID_TREE_LEAF_SIZE 8 //Maximum number of centroids in a leaf
+#define CENTROID_TREE_KMEANS_ITERATIONS 10 //Lloyd iterations when splitting a node
+
+class CentroidTree {
+
+	private:
+		typedef struct {
+			Eigen::VectorXd center;
+			double radius; //Largest distance between the center and one of its centroids
+			long from, to; //Centroids of the node: rows [from, to) of mCentroids
+			std::vector<int> children; //Empty for a leaf
+		} Node;
+
+		Eigen::MatrixXd mCentroids; //Rows reordered so that each node's centroids are contiguous
+		std::vector<int> mLabels;
+		std::vector<Node> mNodes; //mNodes[0] is the root
+		int mBranching;
+		int mLeafSize;
+
+		int build(std::vector<long> &indices, long from, long to, const Eigen::MatrixXd &centroids);
+		void split(std::vector<long> &indices, long from, long to, const Eigen::MatrixXd &centroids,
+			std::vector<long> &boundaries) const;
+
+	public:
+		CentroidTree(const CentroidSet &centroids, int branching = CENTROID_TREE_BRANCHING,
+			int leafSize = CENTROID_TREE_LEAF_SIZE);
+
+		/* Index of the nearest centroid (in the tree's order). With maxChecks == 0 the
+		 * search only stops once the bounds prove the result exact; otherwise it stops
+		 * after computing maxChecks distances and returns the best centroid seen */
+		long nearest(const Eigen::VectorXd &sample, long maxChecks = 0) const;
+		int classify(const Eigen::VectorXd &sample, long maxChecks = 0) const;
+		void classify(std::vector<DataInput::Element> &elements, long maxChecks = 0) const;
+
+		int getDepth() const;
+};
+
+#endif
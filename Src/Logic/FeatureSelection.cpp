@@ -0,0 +1,63 @@
+/*
+ * FeatureSelection.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "FeatureSelection.h"
+#include "Parallel.h"
+#include <limits>
+
+void FeatureSelection::fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) {
+    long nbChunks = (samples.cols() + FEATURE_SELECTION_CHUNK_SIZE - 1) / FEATURE_SELECTION_CHUNK_SIZE;
+    std::vector<Eigen::VectorXd> means(nbChunks), squares(nbChunks), minima(nbChunks), maxima(nbChunks);
+    std::vector<long> counts(nbChunks);
+
+    /* Mean, sum of squared deviations and range of each chunk */
+    parallelFor(nbChunks, [&](long c) {
+	long from = c * FEATURE_SELECTION_CHUNK_SIZE;
+	counts[c] = std::min<long>(FEATURE_SELECTION_CHUNK_SIZE, samples.cols() - from);
+	means[c] = samples.middleCols(from, counts[c]).rowwise().mean();
+	squares[c] = (samples.middleCols(from, counts[c]).colwise() - means[c]).rowwise().squaredNorm();
+	minima[c] = samples.middleCols(from, counts[c]).rowwise().minCoeff();
+	maxima[c] = samples.middleCols(from, counts[c]).rowwise().maxCoeff();
+    });
+
+    /* Chan et al.: M2 = M2_a + M2_b + delta^2 n_a n_b / n */
+    mMeans.setZero(samples.rows());
+    Eigen::VectorXd total = Eigen::VectorXd::Zero(samples.rows());
+    Eigen::VectorXd minimum = Eigen::VectorXd::Constant(samples.rows(), std::numeric_limits<double>::infinity());
+    Eigen::VectorXd maximum = -minimum;
+    long count = 0;
+    for (long c = 0; c < nbChunks; c++) {
+	minimum = minimum.cwiseMin(minima[c]);
+	maximum = maximum.cwiseMax(maxima[c]);
+
+	Eigen::VectorXd delta = means[c] - mMeans;
+	long merged = count + counts[c];
+	total += squares[c] + delta.cwiseAbs2() * (double(count) * counts[c] / merged);
+	mMeans += delta * (double(counts[c]) / merged);
+	count = merged;
+    }
+    mVariances = total / std::max<long>(1, count - 1);
+
+    mIndices.clear();
+    for (int i = 0; i < mVariances.size(); i++)
+	if (maximum(i) > minimum(i) && mVariances(i) > mMinVariance)
+	    mIndices.push_back(i);
+}
+
+void FeatureSelection::apply(Eigen::MatrixXd &samples) const {
+    Eigen::MatrixXd compacted(mIndices.size(), samples.cols());
+
+    /* Gather down each column, which is contiguous */
+    parallelFor((samples.cols() + FEATURE_SELECTION_CHUNK_SIZE - 1) / FEATURE_SELECTION_CHUNK_SIZE, [&](long c) {
+	long to = std::min<long>((c + 1) * FEATURE_SELECTION_CHUNK_SIZE, samples.cols());
+	for (long j = c * FEATURE_SELECTION_CHUNK_SIZE; j < to; j++)
+	    for (unsigned long i = 0; i < mIndices.size(); i++)
+		compacted(i, j) = samples(mIndices[i], j);
+    });
+
+    samples.swap(compacted);
+}
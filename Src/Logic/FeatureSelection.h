@@ -0,0 +1,48 @@
+/*
+ * FeatureSelection.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Variance-based feature pruning: the features that are constant over the
+ * training set (the always-blank border pixels of MNIST), or whose variance
+ * is at most a threshold, are dropped. It runs as a step of a TransformPipeline,
+ * so every model (centroids, weights, PCA basis) trained on the derived data is
+ * compact from the start. With a threshold of 0 only the constant features go,
+ * so centroid and neighbour distances only change by a constant and the
+ * classifications are unchanged; the default also drops the pixels that are
+ * almost never inked.
+ */
+
+#ifndef FEATURESELECTION_H
+#define FEATURESELECTION_H
+
+#include "Transform.h"
+
+#define FEATURE_SELECTION_MIN_VARIANCE 1e-4 //Features with a variance at most this are dropped (std 0.01 on [0, 1] pixels)
+#define FEATURE_SELECTION_CHUNK_SIZE 4096 //Samples per partial statistics
+
+class FeatureSelection : public Transform {
+
+	private:
+		double mMinVariance;
+		Eigen::VectorXd mMeans; //Over all the input features
+		Eigen::VectorXd mVariances;
+		std::vector<int> mIndices; //Kept features, in increasing order
+
+	public:
+		explicit FeatureSelection(double minVariance = FEATURE_SELECTION_MIN_VARIANCE) : mMinVariance(minVariance) {}
+
+		/* Means, variances and ranges in one parallel pass: chunks of samples are reduced
+		 * in parallel, then merged with the pairwise update of Chan et al. A feature whose
+		 * minimum and maximum are equal is constant, whatever the rounding of its variance */
+		void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes);
+		void apply(Eigen::MatrixXd &samples) const;
+		std::string getName() const { return "feature selection"; }
+
+		const std::vector<int> &getIndices() const { return mIndices; }
+		const Eigen::VectorXd &getVariances() const { return mVariances; }
+		int getNbFeatures() const { return mMeans.size(); }
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * ImagePyramid.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "ImagePyramid.h"
+#include "Parallel.h"
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+ImagePyramid::ImagePyramid(const Eigen::MatrixXd &samples, int width, int height, int nbLevels) {
+    mLevels.push_back(samples);
+
+    /* Stop once the images are down to a single block */
+    for (int l = 1, size = 2; l < nbLevels && (size / 2 < width || size / 2 < height); l++, size *= 2) {
+	mPooling.push_back(pooling_matrix(width, height, size));
+	mLevels.push_back(mPooling.back() * samples);
+    }
+}
+
+/* Blocks of at most blockSize x blockSize pixels; the ones on the right and bottom edges may be smaller.
+ * Weighting the mean of a block of n pixels by sqrt(n) makes n (mean(a) - mean(b))^2 its contribution */
+Eigen::SparseMatrix<double> ImagePyramid::pooling_matrix(int width, int height, int blockSize) {
+    int blocksX = (width + blockSize - 1) / blockSize, blocksY = (height + blockSize - 1) / blockSize;
+    std::vector<Eigen::Triplet<double> > entries;
+
+    for (int by = 0; by < blocksY; by++) {
+	for (int bx = 0; bx < blocksX; bx++) {
+	    int toX = std::min(width, (bx + 1) * blockSize), toY = std::min(height, (by + 1) * blockSize);
+	    double weight = 1 / std::sqrt(double((toX - bx * blockSize) * (toY - by * blockSize)));
+
+	    for (int y = by * blockSize; y < toY; y++)
+		for (int x = bx * blockSize; x < toX; x++)
+		    entries.push_back(Eigen::Triplet<double>(by * blocksX + bx, y * width + x, weight));
+	}
+    }
+
+    Eigen::SparseMatrix<double> pooling(blocksX * blocksY, width * height);
+    pooling.setFromTriplets(entries.begin(), entries.end());
+
+    return pooling;
+}
+
+void ImagePyramid::pool(const Eigen::VectorXd &image, std::vector<Eigen::VectorXd> &levels) const {
+    levels.resize(mLevels.size());
+    levels[0] = image;
+    for (unsigned long l = 1; l < mLevels.size(); l++)
+	levels[l] = mPooling[l - 1] * image;
+}
+
+long ImagePyramid::nearest(const Eigen::VectorXd &query, long *refined) const {
+    std::vector<Eigen::VectorXd> levels;
+    pool(query, levels);
+
+    double best = std::numeric_limits<double>::infinity();
+    long bestIndex = -1, count = 0;
+    std::vector<long> done; //Samples refined while pruning
+    auto refine = [&](long i) {
+	double distance = (mLevels[0].col(i) - query).squaredNorm();
+	done.push_back(i);
+	count++;
+	if (distance < best || (distance == best && i < bestIndex)) {
+	    best = distance;
+	    bestIndex = i;
+	}
+    };
+
+    int coarsest = mLevels.size() - 1;
+    if (!coarsest) {
+	(mLevels[0].colwise() - query).colwise().squaredNorm().minCoeff(&bestIndex);
+	count = getNbSamples();
+    } else {
+	/* Coarsest level: bounds of every sample at once */
+	Eigen::VectorXd bounds = (mLevels[coarsest].colwise() - levels[coarsest]).colwise().squaredNorm().transpose();
+	std::vector<long> candidates(getNbSamples());
+	std::iota(candidates.begin(), candidates.end(), 0);
+
+	for (int l = coarsest; l > 0; l--) {
+	    if (l < coarsest)
+		for (unsigned long c = 0; c < candidates.size(); c++)
+		    bounds(c) = (mLevels[l].col(candidates[c]) - levels[l]).squaredNorm();
+
+	    /* The most promising candidate gives a distance to prune against */
+	    Eigen::Index first;
+	    bounds.head(candidates.size()).minCoeff(&first);
+	    refine(candidates[first]);
+
+	    unsigned long kept = 0;
+	    double limit = best * (1 + PYRAMID_TOLERANCE);
+	    for (unsigned long c = 0; c < candidates.size(); c++) {
+		if (bounds(c) <= limit) {
+		    bounds(kept) = bounds(c);
+		    candidates[kept++] = candidates[c];
+		}
+	    }
+	    candidates.resize(kept);
+	}
+
+	/* Full resolution, by increasing bound: stop once the next bound is above the best distance */
+	std::vector<long> order(candidates.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](long a, long b) { return bounds(a) < bounds(b); });
+	for (long c : order) {
+	    if (bounds(c) > best * (1 + PYRAMID_TOLERANCE))
+		break;
+	    if (std::find(done.begin(), done.end(), candidates[c]) == done.end())
+		refine(candidates[c]);
+	}
+    }
+
+    if (refined)
+	*refined += count;
+
+    return bestIndex;
+}
+
+long ImagePyramid::nearest(const Eigen::MatrixXd &queries, std::vector<long> &nearest) const {
+    std::atomic<long> refined(0);
+    nearest.resize(queries.cols());
+
+    parallelFor(queries.cols(), [&](long q) {
+	long count = 0;
+	nearest[q] = this->nearest(Eigen::VectorXd(queries.col(q)), &count);
+	refined += count;
+    });
+
+    return refined;
+}
@@ -0,0 +1,51 @@
+/*
+ * ImagePyramid.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Exact nearest neighbour search, coarse to fine. Level l of the pyramid holds
+ * every image pooled by blocks of 2^l x 2^l pixels, each block being its mean
+ * times sqrt(number of pixels). By Cauchy-Schwarz the squared distance between
+ * two pooled images never exceeds the one at the finer level, so the coarse
+ * levels give lower bounds that rule out most samples before any full
+ * resolution distance is computed.
+ */
+
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include <vector>
+#include "../Eigen/Core"
+#include "../Eigen/SparseCore"
+
+#define PYRAMID_LEVELS 3 //Full resolution, 2x2 and 4x4 pooling
+#define PYRAMID_TOLERANCE 1e-9 //Relative slack on the bounds, so that rounding errors never prune the nearest sample
+
+class ImagePyramid {
+
+	private:
+		std::vector<Eigen::SparseMatrix<double> > mPooling; //Level l = mPooling[l - 1] * image
+		std::vector<Eigen::MatrixXd> mLevels; //One column per sample; mLevels[0] is full resolution
+
+		/* Pixel (x, y) is at y * width + x; any other layout only loosens the bounds */
+		static Eigen::SparseMatrix<double> pooling_matrix(int width, int height, int blockSize);
+
+	public:
+		/* samples: one image of width x height pixels per column */
+		ImagePyramid(const Eigen::MatrixXd &samples, int width, int height, int nbLevels = PYRAMID_LEVELS);
+
+		void pool(const Eigen::VectorXd &image, std::vector<Eigen::VectorXd> &levels) const;
+
+		/* Index of the nearest sample (the first one on ties), exactly as a full scan would find it.
+		 * If given, refined is incremented by the number of full resolution distances computed */
+		long nearest(const Eigen::VectorXd &query, long *refined = nullptr) const;
+		/* Same for every column of queries, in parallel; returns the number of full resolution distances */
+		long nearest(const Eigen::MatrixXd &queries, std::vector<long> &nearest) const;
+
+		int getNbLevels() const { return mLevels.size(); }
+		long getSize(int level) const { return mLevels[level].rows(); } //Dimension of the images at this level
+		long getNbSamples() const { return mLevels[0].cols(); }
+};
+
+#endif
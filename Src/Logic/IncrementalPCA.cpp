@@ -0,0 +1,73 @@
+/*
+ * IncrementalPCA.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "IncrementalPCA.h"
+#include "../Eigen/QR"
+#include "../Eigen/SVD"
+#include <cmath>
+
+IncrementalPCA::IncrementalPCA(int vectorSize, int nbComponents) {
+    mNbComponents = nbComponents;
+    mNbTracked = nbComponents + INCREMENTAL_PCA_EXTRA_COMPONENTS;
+    mNbSamples = 0;
+    mMean.setZero(vectorSize);
+    mBasis.resize(vectorSize, 0);
+}
+
+void IncrementalPCA::update(const Eigen::MatrixXd &batch) {
+    long m = batch.cols();
+    if (!m)
+	return;
+
+    /* New columns: the centered batch, and the mean shift weighted by sqrt(n m / (n + m)) */
+    Eigen::VectorXd batchMean = batch.rowwise().mean();
+    Eigen::MatrixXd columns(batch.rows(), m + 1);
+    columns.leftCols(m) = batch.colwise() - batchMean;
+    columns.col(m) = std::sqrt(double(mNbSamples) * m / (mNbSamples + m)) * (batchMean - mMean);
+
+    /* Split them into their part in the current subspace and an orthonormal residual */
+    long r = mBasis.cols();
+    Eigen::MatrixXd coefficients = mBasis.transpose() * columns;
+    columns.noalias() -= mBasis * coefficients;
+
+    long q = std::min<long>(columns.rows(), m + 1);
+    Eigen::HouseholderQR<Eigen::MatrixXd> qr(columns);
+    Eigen::MatrixXd residualBasis = qr.householderQ() * Eigen::MatrixXd::Identity(columns.rows(), q);
+
+    /* [U S, columns] = [U, Q] [[S, U^T columns], [0, R]]: only the right factor needs an SVD */
+    Eigen::MatrixXd small = Eigen::MatrixXd::Zero(r + q, r + m + 1);
+    small.topLeftCorner(r, r) = mSingularValues.asDiagonal();
+    small.topRightCorner(r, m + 1) = coefficients;
+    small.bottomRightCorner(q, m + 1) = qr.matrixQR().topRows(q).triangularView<Eigen::Upper>();
+
+    Eigen::BDCSVD<Eigen::MatrixXd> svd(small, Eigen::ComputeThinU);
+    long k = std::min<long>(mNbTracked, svd.singularValues().size());
+
+    Eigen::MatrixXd basis(mBasis.rows(), k);
+    basis.noalias() = mBasis * svd.matrixU().topLeftCorner(r, k);
+    basis.noalias() += residualBasis * svd.matrixU().bottomLeftCorner(q, k);
+
+    mBasis.swap(basis);
+    mSingularValues = svd.singularValues().head(k);
+    mMean += double(m) / (mNbSamples + m) * (batchMean - mMean);
+    mNbSamples += m;
+}
+
+void IncrementalPCA::update(SampleStream &stream, long batchSize) {
+    Eigen::MatrixXd batch;
+    Eigen::VectorXi classes;
+
+    while (stream.next(batch, classes, batchSize))
+	update(batch);
+}
+
+ProjectionModel IncrementalPCA::model() const {
+    long k = std::min<long>(mNbComponents, mBasis.cols());
+    Eigen::VectorXd variances = mSingularValues.head(k).cwiseAbs2() / std::max<long>(1, mNbSamples - 1);
+
+    return ProjectionModel(mMean, mBasis.leftCols(k), variances);
+}
@@ -0,0 +1,46 @@
+/*
+ * IncrementalPCA.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Principal components updated from mini-batches, after the incremental SVD
+ * of Ross, Lim, Lin & Yang (2008): the running mean and the top k left
+ * singular vectors of the centered data are kept, and each batch (plus one
+ * column accounting for the shift of the mean) is folded in through the SVD
+ * of a small (k + m + 1) square matrix. Memory stays O(k D + m D) for
+ * batches of m samples, whatever the number of samples seen.
+ */
+
+#ifndef INCREMENTALPCA_H
+#define INCREMENTALPCA_H
+
+#include "PCA.h"
+#include "../DataInput/SampleStream.h"
+
+#define INCREMENTAL_PCA_BATCH_SIZE 256 //Default number of samples per update
+#define INCREMENTAL_PCA_EXTRA_COMPONENTS 10 //Directions tracked beyond k, so that truncation errors do not pile up
+
+class IncrementalPCA {
+
+	private:
+		int mNbComponents;
+		int mNbTracked; //k + INCREMENTAL_PCA_EXTRA_COMPONENTS
+		long mNbSamples;
+		Eigen::VectorXd mMean;
+		Eigen::MatrixXd mBasis; //D x r, r <= mNbTracked left singular vectors
+		Eigen::VectorXd mSingularValues;
+
+	public:
+		IncrementalPCA(int vectorSize, int nbComponents);
+
+		/* Fold in a batch of samples (D x m) */
+		void update(const Eigen::MatrixXd &batch);
+		/* Read the whole stream, batchSize samples at a time */
+		void update(SampleStream &stream, long batchSize = INCREMENTAL_PCA_BATCH_SIZE);
+
+		ProjectionModel model() const;
+		long getNbSamples() const { return mNbSamples; }
+};
+
+#endif
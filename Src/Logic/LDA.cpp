@@ -0,0 +1,55 @@
+/*
+ * LDA.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "LDA.h"
+#include "SymmetricRankUpdate.h"
+#include "../Eigen/Eigenvalues"
+
+ProjectionModel LDA::fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes, int nbClasses,
+	int nbComponents, double regularization) {
+    long size = samples.rows();
+
+    Eigen::MatrixXd means = Eigen::MatrixXd::Zero(size, nbClasses);
+    Eigen::VectorXd counts = Eigen::VectorXd::Zero(nbClasses);
+    for (long i = 0; i < samples.cols(); i++) {
+	means.col(classes(i)) += samples.col(i);
+	counts(classes(i))++;
+    }
+    Eigen::VectorXd mean = means.rowwise().sum() / samples.cols();
+    means *= counts.cwiseMax(1).cwiseInverse().asDiagonal();
+
+    /* Within-class scatter, each chunk being centered on its class means */
+    Eigen::MatrixXd within = Eigen::MatrixXd::Zero(size, size);
+    Eigen::MatrixXd centered;
+    for (long from = 0; from < samples.cols(); from += LDA_CHUNK_SIZE) {
+	long count = std::min<long>(LDA_CHUNK_SIZE, samples.cols() - from);
+	centered = samples.middleCols(from, count);
+	for (long i = 0; i < count; i++)
+	    centered.col(i) -= means.col(classes(from + i));
+
+	symmetricRankUpdate(within, centered);
+    }
+
+    /* Between-class scatter: sum of n_c (m_c - m) (m_c - m)^T */
+    Eigen::MatrixXd between = Eigen::MatrixXd::Zero(size, size);
+    Eigen::MatrixXd spread = (means.colwise() - mean) * counts.cwiseSqrt().asDiagonal();
+    symmetricRankUpdate(between, spread);
+
+    within.diagonal().array() += regularization * within.diagonal().sum() / size + Eigen::NumTraits<double>::epsilon();
+
+    /* Only the lower triangles are read; eigenvalues come in increasing order */
+    Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> eig(between, within, Eigen::ComputeEigenvectors | Eigen::Ax_lBx);
+
+    long k = std::min<long>(nbClasses - 1, size);
+    if (nbComponents > 0)
+	k = std::min<long>(k, nbComponents);
+
+    Eigen::MatrixXd basis = eig.eigenvectors().rightCols(k).rowwise().reverse();
+    Eigen::VectorXd ratios = eig.eigenvalues().tail(k).reverse();
+
+    return ProjectionModel(mean, basis, ratios);
+}
@@ -0,0 +1,32 @@
+/*
+ * LDA.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Fisher linear discriminant analysis: the directions w maximizing the ratio
+ * w^T Sb w / w^T Sw w of the between-class and within-class scatters, found
+ * by the generalized eigenproblem Sb w = l Sw w. Sb has rank C - 1 at most,
+ * so that is as many useful dimensions as there are. Sw is singular as soon
+ * as some features are constant or N < D, so it is regularized by a fraction
+ * of its mean eigenvalue.
+ */
+
+#ifndef LDA_H
+#define LDA_H
+
+#include "PCA.h"
+
+#define LDA_REGULARIZATION 1e-3 //Sw + r * trace(Sw) / D * I
+#define LDA_CHUNK_SIZE 4096 //Samples centered at a time when accumulating Sw
+
+class LDA {
+
+	public:
+		/* samples: D x N, classes: indices in [0, nbClasses). Keeps nbComponents directions,
+		 * or all C - 1 if 0; the model's variances are the discriminant ratios */
+		static ProjectionModel fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes, int nbClasses,
+			int nbComponents = 0, double regularization = LDA_REGULARIZATION);
+};
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * LeastSquares.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "LeastSquares.h"
+#include "NormalOperator.h"
+#include "SymmetricRankUpdate.h"
+#include "../Eigen/Cholesky"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+Eigen::MatrixXd LeastSquares::oneVsRestTargets(const Eigen::VectorXi &classes, int nbClasses) {
+    Eigen::MatrixXd targets(Eigen::MatrixXd::Constant(classes.size(), nbClasses, -1));
+    for (long i = 0; i < classes.size(); i++)
+	targets(i, classes(i)) = 1;
+
+    return targets;
+}
+
+/* Lower triangle of X X^T (primal) or X^T X (dual): parallel SYRK for dense samples */
+static void normal_matrix(const Eigen::MatrixXd &samples, bool dual, Eigen::MatrixXd &gram) {
+    if (dual) {
+	gram.setZero(samples.cols(), samples.cols());
+	symmetricRankUpdate(gram, samples.transpose());
+    } else {
+	gram.setZero(samples.rows(), samples.rows());
+	symmetricRankUpdate(gram, samples);
+    }
+}
+
+/* Sparse product for sparse samples, only the nonzeros being multiplied */
+static void normal_matrix(const Eigen::SparseMatrix<double> &samples, bool dual, Eigen::MatrixXd &gram) {
+    if (dual)
+	gram = Eigen::MatrixXd(samples.transpose() * samples);
+    else
+	gram = Eigen::MatrixXd(samples * samples.transpose());
+}
+
+template <typename Samples>
+static void solve_least_squares(const Samples &samples, const Eigen::MatrixXd &targets, double lambda,
+	Eigen::MatrixXd &weights) {
+    auto begin = std::chrono::steady_clock::now();
+    bool dual = samples.cols() < samples.rows();
+    Eigen::MatrixXd gram;
+    normal_matrix(samples, dual, gram);
+
+    if (dual) {
+	Eigen::MatrixXd coefficients;
+	LeastSquares::solveNormalEquations(gram, targets, lambda, coefficients);
+	weights.noalias() = samples * coefficients;
+    } else {
+	LeastSquares::solveNormalEquations(gram, samples * targets, lambda, weights);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "\t -> Solved the " << (dual ? "dual " : "primal ") << gram.rows() << "x" << gram.cols()
+	<< " system in " << std::chrono::duration<double>(end - begin).count() << "s" << std::endl;
+}
+
+void LeastSquares::solve(const Eigen::MatrixXd &samples, const Eigen::MatrixXd &targets, double lambda,
+	Eigen::MatrixXd &weights) {
+    solve_least_squares(samples, targets, lambda, weights);
+}
+
+void LeastSquares::solve(const Eigen::SparseMatrix<double> &samples, const Eigen::MatrixXd &targets, double lambda,
+	Eigen::MatrixXd &weights) {
+    solve_least_squares(samples, targets, lambda, weights);
+}
+
+void LeastSquares::solveNormalEquations(Eigen::MatrixXd &gram, const Eigen::MatrixXd &rhs, double lambda,
+	Eigen::MatrixXd &weights) {
+    gram.diagonal().array() += lambda; //Make sure the matrix will be invertible
+
+    Eigen::LLT<Eigen::MatrixXd, Eigen::Lower> llt(gram);
+    if (llt.info() == Eigen::Success) {
+	weights = llt.solve(rhs);
+    } else {
+	Eigen::LDLT<Eigen::MatrixXd, Eigen::Lower> ldlt(gram);
+	weights = ldlt.solve(rhs);
+    }
+}
+
+template <typename Samples>
+static void solve_conjugate_gradient(const Samples &samples, const Eigen::MatrixXd &targets, double lambda,
+	Eigen::MatrixXd &weights, double tolerance, int maxIterations) {
+    auto begin = std::chrono::steady_clock::now();
+    NormalOperator<Samples> normal(samples, lambda);
+    Eigen::MatrixXd rhs(samples * targets);
+    Eigen::VectorXd inverseDiagonal = normal.diagonal().cwiseInverse(); //Jacobi preconditioner
+
+    if (weights.rows() != samples.rows() || weights.cols() != targets.cols())
+	weights.setZero(samples.rows(), targets.cols());
+
+    /* residuals = B - A W, then the usual preconditioned CG recurrences for every column,
+     * each with its own step sizes. Only the product with A is done on the whole block */
+    Eigen::MatrixXd residuals(rhs), directions, products(Eigen::MatrixXd::Zero(rhs.rows(), rhs.cols()));
+    normal.apply(products, weights, 1);
+    residuals -= products;
+    directions = inverseDiagonal.asDiagonal() * residuals;
+
+    long nbColumns = rhs.cols();
+    std::vector<int> iterations(nbColumns, 0);
+    std::vector<double> errors(nbColumns, 0);
+    std::vector<bool> active(nbColumns);
+    Eigen::VectorXd thresholds(nbColumns), rhos(nbColumns);
+    for (long c = 0; c < nbColumns; c++) {
+	thresholds(c) = tolerance * rhs.col(c).norm();
+	if (rhs.col(c).isZero(0)) {
+	    weights.col(c).setZero();
+	    residuals.col(c).setZero();
+	}
+	rhos(c) = residuals.col(c).dot(directions.col(c));
+	active[c] = residuals.col(c).norm() > thresholds(c);
+	if (!active[c])
+	    directions.col(c).setZero();
+    }
+
+    for (int k = 0; k < maxIterations && std::find(active.begin(), active.end(), true) != active.end(); k++) {
+	/* One pass over the samples for all the directions */
+	products.setZero();
+	normal.apply(products, directions, 1);
+
+	for (long c = 0; c < nbColumns; c++) {
+	    if (!active[c])
+		continue;
+
+	    double alpha = rhos(c) / directions.col(c).dot(products.col(c));
+	    weights.col(c) += alpha * directions.col(c);
+	    residuals.col(c) -= alpha * products.col(c);
+	    iterations[c] = k + 1;
+	    if (residuals.col(c).norm() <= thresholds(c)) {
+		active[c] = false;
+		directions.col(c).setZero();
+		continue;
+	    }
+
+	    Eigen::VectorXd preconditioned = inverseDiagonal.cwiseProduct(residuals.col(c));
+	    double rho = residuals.col(c).dot(preconditioned);
+	    directions.col(c) = preconditioned + (rho / rhos(c)) * directions.col(c);
+	    rhos(c) = rho;
+	}
+    }
+
+    for (long c = 0; c < nbColumns; c++) {
+	double norm = rhs.col(c).norm();
+	errors[c] = norm > 0 ? residuals.col(c).norm() / norm : 0;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "\t -> Conjugate gradient: " << *std::max_element(iterations.begin(), iterations.end())
+	<< " iterations at most, relative residual " << *std::max_element(errors.begin(), errors.end())
+	<< ", " << std::chrono::duration<double>(end - begin).count() << "s" << std::endl;
+    std::cout << "\t -> Never formed the " << samples.rows() << "x" << samples.rows() << " matrix ("
+	<< samples.rows() * samples.rows() * sizeof(double) / 1048576.0 << " MB)" << std::endl;
+}
+
+void LeastSquares::solveConjugateGradient(const Eigen::MatrixXd &samples, const Eigen::MatrixXd &targets,
+	double lambda, Eigen::MatrixXd &weights, double tolerance, int maxIterations) {
+    solve_conjugate_gradient(samples, targets, lambda, weights, tolerance, maxIterations);
+}
+
+void LeastSquares::solveConjugateGradient(const Eigen::SparseMatrix<double> &samples, const Eigen::MatrixXd &targets,
+	double lambda, Eigen::MatrixXd &weights, double tolerance, int maxIterations) {
+    solve_conjugate_gradient(samples, targets, lambda, weights, tolerance, maxIterations);
+}
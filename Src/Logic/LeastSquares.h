@@ -0,0 +1,52 @@
+/*
+ * LeastSquares.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Regularized least squares solvers for the MSE perceptrons: find W (D x C)
+ * minimizing ||X^T W - Y^T||^2 + lambda ||W||^2, with X holding one sample
+ * per column and Y^T one row of +/-1 targets per sample. The samples are
+ * either dense or sparse (compressed by column), with the same results.
+ */
+
+#ifndef LEASTSQUARES_H
+#define LEASTSQUARES_H
+
+#include "../Eigen/Core"
+#include "../Eigen/SparseCore"
+
+#define MSE_CG_TOLERANCE 1e-6 //Relative residual at which conjugate gradient stops
+#define MSE_CG_MAX_ITERATIONS 500 //Iteration cap of conjugate gradient
+
+class LeastSquares {
+
+	public:
+		/* N x C targets: 1 in the column of the sample's class, -1 elsewhere */
+		static Eigen::MatrixXd oneVsRestTargets(const Eigen::VectorXi &classes, int nbClasses);
+
+		/* Solve with whichever of the D x D primal system (X X^T + lambda I) W = X Y^T
+		 * or the N x N dual system (X^T X + lambda I) A = Y^T, W = X A, is smaller */
+		static void solve(const Eigen::MatrixXd &samples, const Eigen::MatrixXd &targets, double lambda,
+			Eigen::MatrixXd &weights);
+		static void solve(const Eigen::SparseMatrix<double> &samples, const Eigen::MatrixXd &targets, double lambda,
+			Eigen::MatrixXd &weights);
+
+		/* Solve the primal system by Jacobi-preconditioned conjugate gradient, never forming
+		 * X X^T: each product goes through the samples block by block. The C right-hand
+		 * sides are C conjugate gradients run in step, so that an iteration is one pass over
+		 * the samples for all of them. Warm-started from weights if it has the right size */
+		static void solveConjugateGradient(const Eigen::MatrixXd &samples, const Eigen::MatrixXd &targets,
+			double lambda, Eigen::MatrixXd &weights, double tolerance = MSE_CG_TOLERANCE,
+			int maxIterations = MSE_CG_MAX_ITERATIONS);
+		static void solveConjugateGradient(const Eigen::SparseMatrix<double> &samples, const Eigen::MatrixXd &targets,
+			double lambda, Eigen::MatrixXd &weights, double tolerance = MSE_CG_TOLERANCE,
+			int maxIterations = MSE_CG_MAX_ITERATIONS);
+
+		/* Solve (G + lambda I) W = B in place of W, G symmetric with only its lower
+		 * triangle read: Cholesky factorization, LDL^T if it is not positive definite */
+		static void solveNormalEquations(Eigen::MatrixXd &gram, const Eigen::MatrixXd &rhs, double lambda,
+			Eigen::MatrixXd &weights);
+};
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * Metric.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Distances for the nearest neighbour and centroid classifiers, picked at
+ * compile time. A metric is a class with:
+ *  - InnerProduct: 1 if, once the vectors went through prepare(), it ranks
+ *    pairs like ||a - b||^2, i.e. like ||a||^2 - 2 a.b for a fixed query,
+ *  - NeedsFit: 1 if fit() uses the training set, so that callers can skip
+ *    building it otherwise,
+ *  - fit(samples), which learns what the metric needs from the training set,
+ *  - prepare(samples), which maps columns into that space (applied once to
+ *    the samples and once to every query),
+ *  - distance(a, b) on prepared vectors, for the other metrics.
+ * The inner product metrics are searched with one matrix product per block of
+ * queries (the norm trick, see NormTrick.h), the few samples it cannot tell
+ * apart being re-ranked exactly; the others with a loop over the pairs in
+ * which distance() is inlined.
+ */
+
+#ifndef METRIC_H
+#define METRIC_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include "Parallel.h"
+#include "NormTrick.h"
+#include "SymmetricRankUpdate.h"
+#include "../Eigen/Core"
+#include "../Eigen/Cholesky"
+
+#define METRIC_BLOCK_SIZE 256 //Queries per block of distances
+#define MAHALANOBIS_REGULARIZATION 1e-3 //Added to the covariance, relative to the mean variance, so it can be inverted
+
+struct EuclideanMetric {
+	enum { InnerProduct = 1, NeedsFit = 0 };
+
+	static std::string getName() { return "Euclidean"; }
+	void fit(const Eigen::MatrixXd &samples) {}
+	void prepare(Eigen::MatrixXd &samples) const {}
+};
+
+/* 1 - cos(a, b) = ||a / ||a|| - b / ||b||||^2 / 2: Euclidean on the normalized columns */
+struct CosineMetric {
+	enum { InnerProduct = 1, NeedsFit = 0 };
+
+	static std::string getName() { return "Cosine"; }
+	void fit(const Eigen::MatrixXd &samples) {}
+	void prepare(Eigen::MatrixXd &samples) const {
+		Eigen::RowVectorXd norms = samples.colwise().norm();
+		samples.array().rowwise() /= (norms.array() > 0).select(norms.array(), 1);
+	}
+};
+
+/* (a - b)^T S^-1 (a - b) = ||L^-1 a - L^-1 b||^2 with S = L L^T the (regularized)
+ * covariance of the training set: Euclidean once whitened by L^-1 */
+class MahalanobisMetric {
+
+	private:
+		Eigen::MatrixXd mFactor; //L, lower triangular
+		double mRegularization;
+
+	public:
+		enum { InnerProduct = 1, NeedsFit = 1 };
+
+		explicit MahalanobisMetric(double regularization = MAHALANOBIS_REGULARIZATION)
+			: mRegularization(regularization) {}
+
+		static std::string getName() { return "Mahalanobis"; }
+
+		void fit(const Eigen::MatrixXd &samples) {
+			Eigen::MatrixXd centered = samples.colwise() - samples.rowwise().mean();
+			Eigen::MatrixXd covariance = Eigen::MatrixXd::Zero(samples.rows(), samples.rows());
+			symmetricRankUpdate(covariance, centered, 1.0 / std::max<long>(1, samples.cols() - 1));
+
+			double meanVariance = covariance.trace() / std::max<long>(1, samples.rows());
+			covariance.diagonal().array() += mRegularization * (meanVariance > 0 ? meanVariance : 1);
+			mFactor = covariance.selfadjointView<Eigen::Lower>().llt().matrixL();
+		}
+
+		void prepare(Eigen::MatrixXd &samples) const {
+			mFactor.triangularView<Eigen::Lower>().solveInPlace(samples);
+		}
+};
+
+/* ||a - b||_p; P can be Eigen::Infinity */
+template <int P>
+struct LpMetric {
+	enum { InnerProduct = 0, NeedsFit = 0 };
+
+	static std::string getName() { return P == Eigen::Infinity ? "L-infinity" : "L" + std::to_string(P); }
+	void fit(const Eigen::MatrixXd &samples) {}
+	void prepare(Eigen::MatrixXd &samples) const {}
+
+	template <typename A, typename B>
+	static double distance(const Eigen::MatrixBase<A> &a, const Eigen::MatrixBase<B> &b) {
+		return (a - b).template lpNorm<P>();
+	}
+};
+
+/* Nearest prepared sample of each column of a block of prepared queries */
+template <typename Metric, bool InnerProduct = Metric::InnerProduct>
+struct MetricKernel {
+	static void nearest(const Eigen::MatrixXd &samples, const Eigen::VectorXd &squaredNorms,
+		const Eigen::Ref<const Eigen::MatrixXd> &queries, long *nearest) {
+		Eigen::MatrixXd scores(samples.cols(), queries.cols());
+		scores.noalias() = -2 * samples.transpose() * queries;
+		scores.colwise() += squaredNorms;
+
+		double maxNorm = std::sqrt(squaredNorms.maxCoeff());
+		for (long j = 0; j < queries.cols(); j++) {
+			double error = normTrickError(samples.rows(), maxNorm, queries.col(j).norm());
+			nearest[j] = normTrickNearest(scores.col(j), error, [&](long i) {
+				return (samples.col(i) - queries.col(j)).squaredNorm();
+			});
+		}
+	}
+};
+
+template <typename Metric>
+struct MetricKernel<Metric, false> {
+	static void nearest(const Eigen::MatrixXd &samples, const Eigen::VectorXd &squaredNorms,
+		const Eigen::Ref<const Eigen::MatrixXd> &queries, long *nearest) {
+		for (long j = 0; j < queries.cols(); j++) {
+			double lowest = Metric::distance(samples.col(0), queries.col(j));
+			nearest[j] = 0;
+			for (long i = 1; i < samples.cols(); i++) {
+				double distance = Metric::distance(samples.col(i), queries.col(j));
+				if (distance < lowest) {
+					lowest = distance;
+					nearest[j] = i;
+				}
+			}
+		}
+	}
+};
+
+/* Samples (one per column) prepared once for a fitted metric */
+template <typename Metric>
+class MetricSearch {
+
+	private:
+		Metric mMetric;
+		Eigen::MatrixXd mSamples;
+		Eigen::VectorXd mSquaredNorms; //Only used by the inner product metrics
+
+	public:
+		MetricSearch(const Eigen::MatrixXd &samples, const Metric &metric) : mMetric(metric), mSamples(samples) {
+			mMetric.prepare(mSamples);
+			if (Metric::InnerProduct)
+				mSquaredNorms = mSamples.colwise().squaredNorm().transpose();
+		}
+
+		/* Index of the nearest sample for every column of queries, by blocks in parallel */
+		void nearest(const Eigen::MatrixXd &queries, std::vector<long> &nearest) const {
+			Eigen::MatrixXd prepared = queries;
+			mMetric.prepare(prepared);
+			nearest.resize(prepared.cols());
+			if (!mSamples.cols())
+				return;
+
+			parallelFor((prepared.cols() + METRIC_BLOCK_SIZE - 1) / METRIC_BLOCK_SIZE, [&](long b) {
+				long from = b * METRIC_BLOCK_SIZE, count = std::min<long>(METRIC_BLOCK_SIZE, prepared.cols() - from);
+				MetricKernel<Metric>::nearest(mSamples, mSquaredNorms, prepared.middleCols(from, count), &nearest[from]);
+			});
+		}
+};
+
+#endif
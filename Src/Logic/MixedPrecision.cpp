@@ -0,0 +1,84 @@
+/*
+ * MixedPrecision.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "MixedPrecision.h"
+#include "Parallel.h"
+#include "NormTrick.h"
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+MixedPrecisionSearch::MixedPrecisionSearch(const Eigen::MatrixXd &samples, int shortlist)
+    : mSamples(&samples), mShortlist(std::max(1, shortlist)) {
+    mLowSamples = samples.cast<float>();
+    mLowNorms = mLowSamples.colwise().squaredNorm().transpose();
+    mMaxNorm = samples.size() ? samples.colwise().norm().maxCoeff() : 0;
+}
+
+/* The norm trick bound with u = 2^-24: its D + 4 roundings include the ones of both operands to float */
+double MixedPrecisionSearch::scoreError(double queryNorm) const {
+    return normTrickError(mLowSamples.rows(), mMaxNorm, queryNorm, std::numeric_limits<float>::epsilon() / 2);
+}
+
+long MixedPrecisionSearch::nearest(const Eigen::MatrixXd &queries, std::vector<long> &nearest,
+	std::vector<long> *lowPrecision) const {
+    std::atomic<long> reranked(0);
+    nearest.resize(queries.cols());
+    if (lowPrecision)
+	lowPrecision->resize(queries.cols());
+
+    long nbBlocks = (queries.cols() + MIXED_PRECISION_BLOCK_SIZE - 1) / MIXED_PRECISION_BLOCK_SIZE;
+    parallelFor(nbBlocks, [&](long b) {
+	long from = b * MIXED_PRECISION_BLOCK_SIZE, count = std::min<long>(MIXED_PRECISION_BLOCK_SIZE, queries.cols() - from);
+	Eigen::MatrixXf block = queries.middleCols(from, count).cast<float>();
+	Eigen::MatrixXf scores(mLowSamples.cols(), count);
+	scores.noalias() = -2 * mLowSamples.transpose() * block;
+	scores.colwise() += mLowNorms;
+
+	std::vector<long> shortlist;
+	for (long j = 0; j < count; j++) {
+	    const Eigen::VectorXd query = queries.col(from + j);
+	    Eigen::Index best;
+	    double lowest = scores.col(j).minCoeff(&best);
+	    double limit = lowest + 2 * scoreError(query.norm());
+	    if (lowPrecision)
+		(*lowPrecision)[from + j] = best;
+
+	    /* The mShortlist best scores, plus every score within the error margin of the best */
+	    typedef std::pair<float, long> Entry;
+	    std::priority_queue<Entry> top;
+	    shortlist.clear();
+	    for (long i = 0; i < scores.rows(); i++) {
+		if (scores(i, j) <= limit) {
+		    shortlist.push_back(i);
+		} else if ((long) top.size() < mShortlist) {
+		    top.push(Entry(scores(i, j), i));
+		} else if (scores(i, j) < top.top().first) {
+		    top.pop();
+		    top.push(Entry(scores(i, j), i));
+		}
+	    }
+	    while ((long) (shortlist.size() + top.size()) > mShortlist && !top.empty())
+		top.pop();
+	    for (; !top.empty(); top.pop())
+		shortlist.push_back(top.top().second);
+	    std::sort(shortlist.begin(), shortlist.end());
+
+	    double lowestDistance = std::numeric_limits<double>::infinity();
+	    for (long i : shortlist) {
+		double distance = (mSamples->col(i) - query).squaredNorm();
+		if (distance < lowestDistance) {
+		    lowestDistance = distance;
+		    nearest[from + j] = i;
+		}
+	    }
+	    reranked += shortlist.size();
+	}
+    });
+
+    return reranked;
+}
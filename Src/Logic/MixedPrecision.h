@@ -0,0 +1,51 @@
+/*
+ * MixedPrecision.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Nearest neighbour search in two passes: every sample is scored in single
+ * precision (||s||^2 - 2 s.q, one float product per block of queries), then
+ * a shortlist of the best scores is re-ranked with exact double distances.
+ * The float scores are off by at most delta, a worst case bound on their
+ * rounding errors, so any sample scored within 2 delta of the best one could
+ * still be the nearest: those always join the shortlist. The result is the
+ * one of a double precision search, while half the bytes are streamed.
+ */
+
+#ifndef MIXEDPRECISION_H
+#define MIXEDPRECISION_H
+
+#include <vector>
+#include "../Eigen/Core"
+
+#define MIXED_PRECISION_SHORTLIST 8 //Candidates re-ranked in double when the float margin is clear
+#define MIXED_PRECISION_BLOCK_SIZE 256 //Queries per block of float products
+
+class MixedPrecisionSearch {
+
+	private:
+		const Eigen::MatrixXd *mSamples; //Kept by the caller, read again for the re-ranking
+		Eigen::MatrixXf mLowSamples;
+		Eigen::VectorXf mLowNorms;
+		double mMaxNorm;
+		int mShortlist;
+
+	public:
+		/* samples: one per column, must outlive the search */
+		MixedPrecisionSearch(const Eigen::MatrixXd &samples, int shortlist = MIXED_PRECISION_SHORTLIST);
+
+		/* Bound on |float score - exact score| for a query of this norm */
+		double scoreError(double queryNorm) const;
+
+		/* Nearest column of samples (the first one on ties) for every column of queries, in
+		 * parallel. If given, lowPrecision gets the sample with the best float score.
+		 * Returns the total number of samples re-ranked */
+		long nearest(const Eigen::MatrixXd &queries, std::vector<long> &nearest,
+			std::vector<long> *lowPrecision = nullptr) const;
+
+		long getNbSamples() const { return mLowSamples.cols(); }
+		long getMemory() const { return mLowSamples.size() * sizeof(float); } //Bytes of the float samples
+};
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * NormTrick.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * For a fixed query q, ||s - q||^2 ranks like the score ||s||^2 - 2 s.q, which
+ * a whole block of queries gets from one matrix product. The scores are
+ * rounded differently from the distances, though, so two samples at nearly
+ * the same distance can swap places. Every sample scored within twice the
+ * worst case rounding error of the best score could still be the nearest:
+ * re-ranking those with exact distances gives the result of a full scan.
+ */
+
+#ifndef NORMTRICK_H
+#define NORMTRICK_H
+
+#include <limits>
+#include "../Eigen/Core"
+
+/* Bound on |computed score - exact score| for D-dimensional vectors, samples of norm at
+ * most maxNorm and a query of norm queryNorm. A dot product of D terms is within
+ * D u ||s|| ||q|| of the exact one whatever the summation order (u: unit roundoff);
+ * the squared norm, the scaling and the sum add a few more roundings */
+inline double normTrickError(long size, double maxNorm, double queryNorm,
+	double unitRoundoff = std::numeric_limits<double>::epsilon() / 2) {
+    double gamma = (size + 4) * unitRoundoff / (1 - (size + 4) * unitRoundoff);
+
+    return gamma * (maxNorm * maxNorm + 2 * maxNorm * queryNorm);
+}
+
+/* Nearest sample (the first one on ties) from a column of scores: the ones within
+ * 2 error of the best are re-ranked with distance(i), the exact squared distance.
+ * If given, reranked is incremented by the number of distances computed */
+template <typename Scores, typename Distance>
+long normTrickNearest(const Eigen::MatrixBase<Scores> &scores, double error, Distance distance,
+	long *reranked = nullptr) {
+    double limit = scores.minCoeff() + 2 * error;
+    double lowest = std::numeric_limits<double>::infinity();
+    long nearest = 0;
+
+    for (long i = 0; i < scores.size(); i++) {
+	if (scores(i) > limit)
+	    continue;
+
+	double exact = distance(i);
+	if (exact < lowest) {
+	    lowest = exact;
+	    nearest = i;
+	}
+	if (reranked)
+	    (*reranked)++;
+    }
+
+    return nearest;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * NormalEquations.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "NormalEquations.h"
+#include "LeastSquares.h"
+#include "SymmetricRankUpdate.h"
+
+NormalEquations::NormalEquations(int vectorSize, int nbClasses, unsigned int nbThreads) {
+    mGram.setZero(vectorSize, vectorSize);
+    mRhs.setZero(vectorSize, nbClasses);
+    mNbSamples = 0;
+    mNbThreads = nbThreads ? nbThreads : nbWorkerThreads();
+}
+
+void NormalEquations::accumulate(const Eigen::MatrixXd &chunk, const Eigen::VectorXi &classes) {
+    symmetricRankUpdate(mGram, chunk, 1, mNbThreads);
+
+    mRhs.noalias() += chunk * LeastSquares::oneVsRestTargets(classes, mRhs.cols());
+    mNbSamples += chunk.cols();
+}
+
+void NormalEquations::accumulate(SampleStream &stream, long chunkSize) {
+    Eigen::MatrixXd chunk;
+    Eigen::VectorXi classes;
+
+    while (stream.next(chunk, classes, chunkSize))
+	accumulate(chunk, classes);
+}
+
+void NormalEquations::solve(double lambda, Eigen::MatrixXd &weights) const {
+    Eigen::MatrixXd gram(mGram);
+    LeastSquares::solveNormalEquations(gram, mRhs, lambda, weights);
+}
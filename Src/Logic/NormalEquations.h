@@ -0,0 +1,41 @@
+/*
+ * NormalEquations.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Accumulates the normal equations of the MSE perceptrons, X X^T and X Y^T,
+ * one chunk of samples at a time, so that training only needs O(D^2 + chunk)
+ * memory whatever the number of samples.
+ */
+
+#ifndef NORMALEQUATIONS_H
+#define NORMALEQUATIONS_H
+
+#include "../DataInput/SampleStream.h"
+
+#define NORMAL_EQUATIONS_CHUNK_SIZE 4096 //Default number of samples read at once
+
+class NormalEquations {
+
+	private:
+		Eigen::MatrixXd mGram; //X X^T, lower triangle only
+		Eigen::MatrixXd mRhs; //X Y^T
+		long mNbSamples;
+		unsigned int mNbThreads;
+
+	public:
+		NormalEquations(int vectorSize, int nbClasses, unsigned int nbThreads = 0);
+
+		/* Add the samples of chunk (D x n) and their class indices */
+		void accumulate(const Eigen::MatrixXd &chunk, const Eigen::VectorXi &classes);
+		/* Read the whole stream, chunkSize samples at a time */
+		void accumulate(SampleStream &stream, long chunkSize = NORMAL_EQUATIONS_CHUNK_SIZE);
+
+		/* Weights (D x C) solving (X X^T + lambda I) W = X Y^T */
+		void solve(double lambda, Eigen::MatrixXd &weights) const;
+
+		long getNbSamples() const { return mNbSamples; }
+};
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * NormalOperator.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Matrix-free operator v -> (X X^T + lambda I) v for the conjugate gradient
+ * of LeastSquares, applied as X (X^T v) by walking over blocks of training
+ * samples, so that the D x D matrix is never formed. X is an Eigen::MatrixXd
+ * or a column-major Eigen::SparseMatrix<double>. Its diagonal, the squared
+ * norm of each row of X plus lambda, gives the Jacobi preconditioner.
+ */
+
+#ifndef NORMALOPERATOR_H
+#define NORMALOPERATOR_H
+
+#include <algorithm>
+#include "../Eigen/Core"
+
+#define NORMAL_OPERATOR_BLOCK_SIZE 2048 //Samples per block when applying the operator
+
+template <typename Samples>
+class NormalOperator {
+
+	private:
+		const Samples *mSamples;
+		double mLambda;
+
+	public:
+		NormalOperator(const Samples &samples, double lambda) : mSamples(&samples), mLambda(lambda) {}
+
+		/* dst += alpha (X X^T + lambda I) rhs, for a whole block of vectors at once */
+		template<typename Dest, typename Rhs>
+		void apply(Dest &dst, const Rhs &rhs, double alpha) const {
+			Eigen::MatrixXd projections;
+			for (Eigen::Index from = 0; from < mSamples->cols(); from += NORMAL_OPERATOR_BLOCK_SIZE) {
+				Eigen::Index count = std::min<Eigen::Index>(NORMAL_OPERATOR_BLOCK_SIZE, mSamples->cols() - from);
+				projections.noalias() = mSamples->middleCols(from, count).transpose() * rhs;
+				dst.noalias() += alpha * mSamples->middleCols(from, count) * projections;
+			}
+			dst += alpha * mLambda * rhs;
+		}
+
+		Eigen::VectorXd diagonal() const {
+			return (mSamples->cwiseAbs2() * Eigen::VectorXd::Ones(mSamples->cols())).array() + mLambda;
+		}
+};
+
+#endif
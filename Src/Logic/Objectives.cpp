@@ -0,0 +1,85 @@
+/*
+ * Objectives.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "Objectives.h"
+#include <cmath>
+#include <algorithm>
+
+PerceptronObjective::PerceptronObjective(const SampleMatrix &samples, const Eigen::VectorXi &classes, int nbClasses,
+	int firstClass)
+    : mSamples(samples), mClasses(classes), mFirstClass(firstClass), mOutputs(nbClasses, samples.cols()),
+      mMisclassified(nbClasses, samples.cols()), mNbMisclassified(0) {
+}
+
+double PerceptronObjective::evaluate(const Eigen::VectorXd &x, Eigen::VectorXd &gradient) {
+    Eigen::Map<const Eigen::MatrixXd> weights(x.data(), mSamples.rows(), mOutputs.rows());
+    Eigen::Map<Eigen::MatrixXd> gradients(gradient.data(), mSamples.rows(), mOutputs.rows());
+
+    /* Criterion function of every class at once */
+    mSamples.transposedProduct(weights, mOutputs);
+
+    double criterion = 0;
+    mNbMisclassified = 0;
+    for (long i = 0; i < mOutputs.cols(); i++) {
+	for (long n = 0; n < mOutputs.rows(); n++) {
+	    double y = mClasses(i) == mFirstClass + n ? 1 : -1;
+	    bool wrong = y * mOutputs(n, i) < 0;
+	    mMisclassified(n, i) = wrong ? y : 0;
+	    mNbMisclassified += wrong;
+	    criterion -= wrong ? y * mOutputs(n, i) : 0;
+	}
+    }
+
+    /* Gradient of every class: minus the sum of y_ci * x_i over its misclassified elements */
+    mSamples.productTransposed(mMisclassified, -1, gradients);
+
+    return criterion;
+}
+
+
+SoftmaxObjective::SoftmaxObjective(const SampleMatrix &samples, const Eigen::VectorXi &classes, int nbClasses,
+	double lambda)
+    : mSamples(samples), mClasses(classes), mLambda(lambda), mProbabilities(nbClasses, samples.cols()) {
+}
+
+double SoftmaxObjective::forward(const Eigen::Map<const Eigen::MatrixXd> &weights) {
+    mSamples.transposedProduct(weights, mProbabilities);
+
+    double cross_entropy = 0;
+    for (long i = 0; i < mProbabilities.cols(); i++) {
+	/* Shift by the largest output so that exp() cannot overflow */
+	double largest = mProbabilities.col(i).maxCoeff();
+	mProbabilities.col(i) = (mProbabilities.col(i).array() - largest).exp();
+	double sum = mProbabilities.col(i).sum();
+
+	mProbabilities.col(i) /= sum;
+	cross_entropy -= std::log(std::max(mProbabilities(mClasses(i), i), 1e-300));
+    }
+
+    Eigen::Index nbFeatures = weights.rows() - 1;
+    return cross_entropy / mSamples.cols() + mLambda / 2 * weights.topRows(nbFeatures).squaredNorm();
+}
+
+double SoftmaxObjective::evaluate(const Eigen::VectorXd &x, Eigen::VectorXd &gradient) {
+    Eigen::Map<const Eigen::MatrixXd> weights(x.data(), mSamples.rows(), mProbabilities.rows());
+    Eigen::Map<Eigen::MatrixXd> gradients(gradient.data(), mSamples.rows(), mProbabilities.rows());
+
+    double f = forward(weights);
+
+    /* dJ/dW = X (P - Y)^T / N + lambda W */
+    for (long i = 0; i < mProbabilities.cols(); i++)
+	mProbabilities(mClasses(i), i) -= 1;
+
+    mSamples.productTransposed(mProbabilities, 1.0 / mSamples.cols(), gradients);
+    gradients.topRows(gradients.rows() - 1) += mLambda * weights.topRows(weights.rows() - 1);
+
+    return f;
+}
+
+double SoftmaxObjective::loss(const Eigen::VectorXd &x) {
+    return forward(Eigen::Map<const Eigen::MatrixXd>(x.data(), mSamples.rows(), mProbabilities.rows()));
+}
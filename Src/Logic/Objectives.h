@@ -0,0 +1,61 @@
+/*
+ * Objectives.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Training criteria of the linear classifiers, as functions of the flattened
+ * (column-major) weight matrix so that any Optimizer can minimize them.
+ * samples holds one augmented element per column and classes the index of
+ * the class of each column. Buffers are allocated once, at construction.
+ */
+
+#ifndef OBJECTIVES_H
+#define OBJECTIVES_H
+
+#include "Optimizer.h"
+#include "SparseData.h"
+
+/* Perceptron criterion: J(W) = - sum over misclassified (c, i) of y_ci w_c^T x_i,
+ * y_ci being 1 for the element's own class and -1 otherwise. W has one column per
+ * class in [firstClass, firstClass + nbClasses), so a single one-vs-rest
+ * perceptron is nbClasses = 1 */
+class PerceptronObjective : public Objective {
+
+	private:
+		SampleMatrix mSamples; //Dense or sparse
+		const Eigen::VectorXi &mClasses;
+		int mFirstClass;
+		Eigen::MatrixXd mOutputs; //w_c^T x_i for every class and element
+		Eigen::MatrixXd mMisclassified; //y_ci if misclassified, 0 otherwise
+		long mNbMisclassified;
+
+	public:
+		PerceptronObjective(const SampleMatrix &samples, const Eigen::VectorXi &classes, int nbClasses,
+			int firstClass = 0);
+
+		double evaluate(const Eigen::VectorXd &x, Eigen::VectorXd &gradient);
+		long getNbMisclassified() const { return mNbMisclassified; } //As of the last evaluation
+};
+
+/* Multinomial logistic regression: mean cross-entropy of the softmax of W^T x,
+ * plus lambda / 2 ||W||^2 (the bias row is not regularized) */
+class SoftmaxObjective : public Objective {
+
+	private:
+		SampleMatrix mSamples; //Dense or sparse
+		const Eigen::VectorXi &mClasses;
+		double mLambda;
+		Eigen::MatrixXd mProbabilities; //Softmax outputs, then P - Y for the gradient
+
+		double forward(const Eigen::Map<const Eigen::MatrixXd> &weights);
+
+	public:
+		SoftmaxObjective(const SampleMatrix &samples, const Eigen::VectorXi &classes, int nbClasses, double lambda);
+
+		double evaluate(const Eigen::VectorXd &x, Eigen::VectorXd &gradient);
+		/* Value only, e.g. for a validation set */
+		double loss(const Eigen::VectorXd &x);
+};
+
+#endif
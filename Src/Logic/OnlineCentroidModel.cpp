@@ -0,0 +1,114 @@
+/*
+ * OnlineCentroidModel.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "OnlineCentroidModel.h"
+
+OnlineCentroidModel::OnlineCentroidModel() : mVersion(0) {
+}
+
+/* Welford update of the running mean: m_n = m_(n-1) + (x - m_(n-1)) / n */
+void OnlineCentroidModel::add_locked(const Eigen::VectorXd &sample, int label) {
+    ClassStatistics &statistics = mClasses[label];
+
+    if (!statistics.count)
+	statistics.mean.setZero(sample.size());
+
+    statistics.count++;
+    statistics.mean += (sample - statistics.mean) / statistics.count;
+}
+
+/* Inverse update: m_(n-1) = m_n - (x - m_n) / (n - 1) */
+bool OnlineCentroidModel::remove_locked(const Eigen::VectorXd &sample, int label) {
+    auto statistics = mClasses.find(label);
+    if (statistics == mClasses.end() || !statistics->second.count)
+	return false;
+
+    if (statistics->second.count == 1) {
+	mClasses.erase(statistics);
+	return true;
+    }
+
+    statistics->second.count--;
+    statistics->second.mean -= (sample - statistics->second.mean) / statistics->second.count;
+
+    return true;
+}
+
+void OnlineCentroidModel::add(const Eigen::VectorXd &sample, int label) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    add_locked(sample, label);
+    mVersion++;
+}
+
+bool OnlineCentroidModel::remove(const Eigen::VectorXd &sample, int label) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!remove_locked(sample, label))
+	return false;
+
+    mVersion++;
+    return true;
+}
+
+void OnlineCentroidModel::add(const std::vector<DataInput::Element> &batch) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto const &element : batch)
+	add_locked(element.data, element.label);
+
+    mVersion++;
+}
+
+long OnlineCentroidModel::remove(const std::vector<DataInput::Element> &batch) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    long removed = 0;
+    for (auto const &element : batch)
+	removed += remove_locked(element.data, element.label);
+
+    if (removed)
+	mVersion++;
+
+    return removed;
+}
+
+std::shared_ptr<const CentroidSet> OnlineCentroidModel::snapshot() const {
+    std::shared_ptr<const Snapshot> current = std::atomic_load(&mSnapshot);
+
+    if (!current || current->version != mVersion) {
+	/* Rebuild under the update lock so the snapshot never mixes two versions */
+	std::lock_guard<std::mutex> lock(mMutex);
+	current = std::atomic_load(&mSnapshot);
+
+	if (!current || current->version != mVersion) {
+	    std::vector<int> labels;
+	    Eigen::MatrixXd centroids(mClasses.size(), mClasses.empty() ? 0 : mClasses.begin()->second.mean.size());
+	    for (auto const &statistics : mClasses) {
+		centroids.row(labels.size()) = statistics.second.mean.transpose();
+		labels.push_back(statistics.first);
+	    }
+
+	    current = std::make_shared<const Snapshot>(Snapshot{mVersion, CentroidSet(centroids, labels)});
+	    std::atomic_store(&mSnapshot, current);
+	}
+    }
+
+    return std::shared_ptr<const CentroidSet>(current, &current->centroids);
+}
+
+void OnlineCentroidModel::classify(std::vector<DataInput::Element> &elements) const {
+    snapshot()->classify(elements);
+}
+
+long OnlineCentroidModel::getCount(int label) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto statistics = mClasses.find(label);
+
+    return statistics == mClasses.end() ? 0 : statistics->second.count;
+}
+
+int OnlineCentroidModel::getNbClasses() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mClasses.size();
+}
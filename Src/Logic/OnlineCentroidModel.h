@@ -0,0 +1,65 @@
+/*
+ * OnlineCentroidModel.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Nearest class centroid model updated incrementally as labeled samples
+ * arrive (or are withdrawn), keeping a count and running mean per class.
+ * Updates are O(D) per sample; classification runs on an immutable snapshot
+ * of the centroids, rebuilt lazily when the model changed, so it can be
+ * queried from other threads while it is being updated.
+ */
+
+#ifndef ONLINECENTROIDMODEL_H
+#define ONLINECENTROIDMODEL_H
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include "CentroidSet.h"
+
+class OnlineCentroidModel {
+
+	private:
+		typedef struct {
+			long count;
+			Eigen::VectorXd mean;
+		} ClassStatistics;
+
+		typedef struct {
+			unsigned long version; //Model version the centroids were built from
+			CentroidSet centroids;
+		} Snapshot;
+
+		std::map<int, ClassStatistics> mClasses;
+		std::atomic<unsigned long> mVersion;
+		mutable std::shared_ptr<const Snapshot> mSnapshot; //Only accessed through std::atomic_load/store
+		mutable std::mutex mMutex; //Serializes updates and snapshot rebuilds
+
+		void add_locked(const Eigen::VectorXd &sample, int label);
+		bool remove_locked(const Eigen::VectorXd &sample, int label);
+
+	public:
+		OnlineCentroidModel();
+
+		/* Add a single labeled sample */
+		void add(const Eigen::VectorXd &sample, int label);
+		/* Withdraw a sample previously added; returns false if its class is empty */
+		bool remove(const Eigen::VectorXd &sample, int label);
+		/* Add a mini-batch; readers see either none or all of it */
+		void add(const std::vector<DataInput::Element> &batch);
+		/* Withdraw a mini-batch; returns the number of samples actually removed */
+		long remove(const std::vector<DataInput::Element> &batch);
+
+		/* Consistent view of the centroids as of the last completed update */
+		std::shared_ptr<const CentroidSet> snapshot() const;
+		/* Classify the elements against a single snapshot */
+		void classify(std::vector<DataInput::Element> &elements) const;
+
+		long getCount(int label) const;
+		int getNbClasses() const;
+};
+
+#endif
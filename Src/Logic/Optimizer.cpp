@@ -0,0 +1,406 @@
+/*
+ * Optimizer.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "Optimizer.h"
+#include <deque>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+Optimizer::Optimizer() {
+    mMaxIterations = OPTIMIZER_MAX_ITERATIONS;
+    mGradientTolerance = 1e-5;
+    mFunctionTolerance = 0; //Disabled
+    mPatience = 0;
+}
+
+void Optimizer::setStoppingCriteria(int maxIterations, double gradientTolerance, double functionTolerance) {
+    mMaxIterations = maxIterations;
+    mGradientTolerance = gradientTolerance;
+    mFunctionTolerance = functionTolerance;
+}
+
+void Optimizer::setCallback(std::function<bool(int, const Eigen::VectorXd &, double)> callback) {
+    mCallback = callback;
+}
+
+void Optimizer::setEarlyStopping(std::function<double(const Eigen::VectorXd &)> validationLoss, int patience) {
+    mValidationLoss = validationLoss;
+    mPatience = patience;
+}
+
+void Optimizer::start(const Eigen::VectorXd &x) {
+    mBestValidationLoss = std::numeric_limits<double>::infinity();
+    mIterationsWithoutProgress = 0;
+
+    if (mValidationLoss) {
+	mBestValidationLoss = mValidationLoss(x);
+	mBestParameters = x;
+    }
+}
+
+bool Optimizer::stop(int k, const Eigen::VectorXd &x, double f, double previous, const Eigen::VectorXd &gradient) {
+    if (mCallback && mCallback(k, x, f))
+	return true;
+
+    if (mValidationLoss) {
+	double loss = mValidationLoss(x);
+	if (loss < mBestValidationLoss) {
+	    mBestValidationLoss = loss;
+	    mBestParameters = x;
+	    mIterationsWithoutProgress = 0;
+	} else if (++mIterationsWithoutProgress >= mPatience) {
+	    return true;
+	}
+    }
+
+    if (gradient.norm() <= mGradientTolerance * std::max(1.0, x.norm()))
+	return true;
+
+    if (mFunctionTolerance > 0 && std::abs(previous - f) <= mFunctionTolerance * std::max(1.0, std::abs(f)))
+	return true;
+
+    return k + 1 >= mMaxIterations;
+}
+
+void Optimizer::finish(Eigen::VectorXd &x) {
+    if (mValidationLoss)
+	x = mBestParameters;
+}
+
+
+GradientDescent::GradientDescent(double learningRate, double momentum, bool nesterov) {
+    mLearningRate = learningRate;
+    mMomentum = momentum;
+    mNesterov = nesterov;
+}
+
+/* v <- mu v - lr g, then x <- x + v. Nesterov's variant is written in terms of the
+ * gradient at x: x <- x - mu v_old + (1 + mu) v, so it needs a single evaluation */
+int GradientDescent::minimize(Objective &objective, Eigen::VectorXd &x) {
+    Eigen::VectorXd gradient(x.size()), velocity(Eigen::VectorXd::Zero(x.size())), previous_velocity(x.size());
+    start(x);
+    double f = objective.evaluate(x, gradient), previous;
+    int k = 0;
+
+    if (gradient.norm() <= mGradientTolerance * std::max(1.0, x.norm())) {
+	finish(x);
+	return 0;
+    }
+
+    for (; k < mMaxIterations; k++) {
+	if (mNesterov) {
+	    previous_velocity = velocity;
+	    velocity = mMomentum * velocity - mLearningRate * gradient;
+	    x += (1 + mMomentum) * velocity - mMomentum * previous_velocity;
+	} else {
+	    velocity = mMomentum * velocity - mLearningRate * gradient;
+	    x += velocity;
+	}
+
+	previous = f;
+	f = objective.evaluate(x, gradient);
+
+	if (stop(k, x, f, previous, gradient)) {
+	    k++;
+	    break;
+	}
+    }
+
+    finish(x);
+    return k;
+}
+
+
+Adam::Adam(double learningRate, double beta1, double beta2, double epsilon) {
+    mLearningRate = learningRate;
+    mBeta1 = beta1;
+    mBeta2 = beta2;
+    mEpsilon = epsilon;
+}
+
+int Adam::minimize(Objective &objective, Eigen::VectorXd &x) {
+    Eigen::VectorXd gradient(x.size());
+    Eigen::VectorXd first_moment(Eigen::VectorXd::Zero(x.size())), second_moment(Eigen::VectorXd::Zero(x.size()));
+    start(x);
+    double f = objective.evaluate(x, gradient), previous;
+    double beta1_power = 1, beta2_power = 1;
+    int k = 0;
+
+    if (gradient.norm() <= mGradientTolerance * std::max(1.0, x.norm())) {
+	finish(x);
+	return 0;
+    }
+
+    for (; k < mMaxIterations; k++) {
+	first_moment = mBeta1 * first_moment + (1 - mBeta1) * gradient;
+	second_moment = mBeta2 * second_moment + (1 - mBeta2) * gradient.cwiseAbs2();
+	beta1_power *= mBeta1;
+	beta2_power *= mBeta2;
+
+	/* Bias corrected step */
+	double rate = mLearningRate * std::sqrt(1 - beta2_power) / (1 - beta1_power);
+	x.array() -= rate * first_moment.array() / (second_moment.array().sqrt() + mEpsilon);
+
+	previous = f;
+	f = objective.evaluate(x, gradient);
+
+	if (stop(k, x, f, previous, gradient)) {
+	    k++;
+	    break;
+	}
+    }
+
+    finish(x);
+    return k;
+}
+
+
+LBFGS::LBFGS(int history, double functionDecrease, double curvature) {
+    mHistory = history;
+    mFunctionDecrease = functionDecrease;
+    mCurvature = curvature;
+}
+
+int LBFGS::minimize(Objective &objective, Eigen::VectorXd &x) {
+    std::deque<Eigen::VectorXd> s, y; //x_k+1 - x_k and g_k+1 - g_k, oldest first
+    std::deque<double> rho;
+    std::vector<double> alpha(mHistory);
+    Eigen::VectorXd gradient(x.size()), direction(x.size());
+    Eigen::VectorXd previous_x(x.size()), previous_gradient(x.size());
+    start(x);
+    double f = objective.evaluate(x, gradient), previous;
+    int k = 0;
+
+    if (gradient.norm() <= mGradientTolerance * std::max(1.0, x.norm())) {
+	finish(x);
+	return 0;
+    }
+
+    for (; k < mMaxIterations; k++) {
+	/* Two-loop recursion: direction = -H g */
+	direction = -gradient;
+	for (int i = s.size() - 1; i >= 0; i--) {
+	    alpha[i] = rho[i] * s[i].dot(direction);
+	    direction -= alpha[i] * y[i];
+	}
+	if (!s.empty())
+	    direction *= s.back().dot(y.back()) / y.back().squaredNorm();
+	for (unsigned int i = 0; i < s.size(); i++)
+	    direction += s[i] * (alpha[i] - rho[i] * y[i].dot(direction));
+
+	/* Fall back to steepest descent if the curvature information went bad */
+	if (gradient.dot(direction) >= 0) {
+	    s.clear(); y.clear(); rho.clear();
+	    direction = -gradient;
+	}
+
+	previous_x = x;
+	previous_gradient = gradient;
+	previous = f;
+	double step = s.empty() ? 1 / direction.norm() : 1;
+
+	if (!lineSearch(objective, x, f, gradient, direction, step)) {
+	    x = previous_x;
+	    gradient = previous_gradient;
+	    f = previous;
+
+	    /* Already steepest descent: nothing more can be done */
+	    if (s.empty())
+		break;
+
+	    s.clear(); y.clear(); rho.clear();
+	    continue;
+	}
+
+	s.push_back(x - previous_x);
+	y.push_back(gradient - previous_gradient);
+	double curvature = s.back().dot(y.back());
+	if (curvature > std::numeric_limits<double>::epsilon() * y.back().squaredNorm()) {
+	    rho.push_back(1 / curvature);
+	    if ((int) s.size() > mHistory) {
+		s.pop_front(); y.pop_front(); rho.pop_front();
+	    }
+	} else {
+	    s.pop_back(); y.pop_back();
+	}
+
+	if (stop(k, x, f, previous, gradient)) {
+	    k++;
+	    break;
+	}
+    }
+
+    finish(x);
+    return k;
+}
+
+/* Safeguarded step of More & Thuente (MINPACK-2 dcstep): updates the interval of
+ * uncertainty [stx, sty] with the trial step stp and computes the next trial step
+ * from cubic and quadratic interpolations of the function values and derivatives */
+static void lineSearchStep(double &stx, double &fx, double &dx, double &sty, double &fy, double &dy,
+	double &stp, double fp, double dp, bool &bracketed, double stpmin, double stpmax) {
+    double sgnd = dp * (dx / std::abs(dx));
+    double stpf, stpc, stpq, theta, s, gamma, p, q, r;
+
+    if (fp > fx) {
+	/* Higher function value: the minimum is bracketed */
+	theta = 3 * (fx - fp) / (stp - stx) + dx + dp;
+	s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+	gamma = s * std::sqrt((theta / s) * (theta / s) - (dx / s) * (dp / s));
+	if (stp < stx)
+	    gamma = -gamma;
+	p = (gamma - dx) + theta;
+	q = ((gamma - dx) + gamma) + dp;
+	r = p / q;
+	stpc = stx + r * (stp - stx);
+	stpq = stx + ((dx / ((fx - fp) / (stp - stx) + dx)) / 2) * (stp - stx);
+	stpf = std::abs(stpc - stx) < std::abs(stpq - stx) ? stpc : stpc + (stpq - stpc) / 2;
+	bracketed = true;
+    } else if (sgnd < 0) {
+	/* Derivatives of opposite sign: the minimum is bracketed */
+	theta = 3 * (fx - fp) / (stp - stx) + dx + dp;
+	s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+	gamma = s * std::sqrt((theta / s) * (theta / s) - (dx / s) * (dp / s));
+	if (stp > stx)
+	    gamma = -gamma;
+	p = (gamma - dp) + theta;
+	q = ((gamma - dp) + gamma) + dx;
+	r = p / q;
+	stpc = stp + r * (stx - stp);
+	stpq = stp + (dp / (dp - dx)) * (stx - stp);
+	stpf = std::abs(stpc - stp) > std::abs(stpq - stp) ? stpc : stpq;
+	bracketed = true;
+    } else if (std::abs(dp) < std::abs(dx)) {
+	/* Derivative decreases in magnitude */
+	theta = 3 * (fx - fp) / (stp - stx) + dx + dp;
+	s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+	gamma = s * std::sqrt(std::max(0.0, (theta / s) * (theta / s) - (dx / s) * (dp / s)));
+	if (stp > stx)
+	    gamma = -gamma;
+	p = (gamma - dp) + theta;
+	q = (gamma + (dx - dp)) + gamma;
+	r = p / q;
+	if (r < 0 && gamma != 0)
+	    stpc = stp + r * (stx - stp);
+	else
+	    stpc = stp > stx ? stpmax : stpmin;
+	stpq = stp + (dp / (dp - dx)) * (stx - stp);
+
+	if (bracketed) {
+	    stpf = std::abs(stpc - stp) < std::abs(stpq - stp) ? stpc : stpq;
+	    if (stp > stx)
+		stpf = std::min(stp + 0.66 * (sty - stp), stpf);
+	    else
+		stpf = std::max(stp + 0.66 * (sty - stp), stpf);
+	} else {
+	    stpf = std::abs(stpc - stp) > std::abs(stpq - stp) ? stpc : stpq;
+	    stpf = std::max(stpmin, std::min(stpmax, stpf));
+	}
+    } else {
+	/* Derivative does not decrease in magnitude */
+	if (bracketed) {
+	    theta = 3 * (fp - fy) / (sty - stp) + dy + dp;
+	    s = std::max(std::abs(theta), std::max(std::abs(dy), std::abs(dp)));
+	    gamma = s * std::sqrt((theta / s) * (theta / s) - (dy / s) * (dp / s));
+	    if (stp > sty)
+		gamma = -gamma;
+	    p = (gamma - dp) + theta;
+	    q = ((gamma - dp) + gamma) + dy;
+	    r = p / q;
+	    stpf = stp + r * (sty - stp);
+	} else {
+	    stpf = stp > stx ? stpmax : stpmin;
+	}
+    }
+
+    /* Update the interval which contains a minimizer */
+    if (fp > fx) {
+	sty = stp; fy = fp; dy = dp;
+    } else {
+	if (sgnd < 0) {
+	    sty = stx; fy = fx; dy = dx;
+	}
+	stx = stp; fx = fp; dx = dp;
+    }
+
+    stp = stpf;
+}
+
+/* More & Thuente line search (MINPACK-2 dcsrch), looking for a step satisfying
+ * the strong Wolfe conditions f(x + a d) <= f(x) + c1 a g.d and |g(x + a d).d| <= c2 |g.d| */
+bool LBFGS::lineSearch(Objective &objective, Eigen::VectorXd &x, double &f, Eigen::VectorXd &gradient,
+	const Eigen::VectorXd &direction, double &step) {
+    const double xtrapl = 1.1, xtrapu = 4, xtol = 1e-10, stpmin = 0, stpmax = 1e20;
+    const Eigen::VectorXd origin(x);
+    const double finit = f, ginit = gradient.dot(direction), gtest = mFunctionDecrease * ginit;
+
+    if (ginit >= 0)
+	return false;
+
+    bool bracketed = false;
+    int stage = 1;
+    double width = stpmax - stpmin, width1 = 2 * width;
+    double stx = 0, fx = finit, gx = ginit;
+    double sty = 0, fy = finit, gy = ginit;
+    double stmin = 0, stmax = step + xtrapu * step;
+
+    for (int evaluation = 0; evaluation < LINE_SEARCH_MAX_EVALUATIONS; evaluation++) {
+	x = origin + step * direction;
+	f = objective.evaluate(x, gradient);
+	double g = gradient.dot(direction), ftest = finit + step * gtest;
+
+	if (stage == 1 && f <= ftest && g >= 0)
+	    stage = 2;
+
+	/* Strong Wolfe conditions hold */
+	if (f <= ftest && std::abs(g) <= mCurvature * -ginit)
+	    return true;
+
+	/* Rounding errors or interval too small: accept any decrease */
+	if ((bracketed && (step <= stmin || step >= stmax)) || (bracketed && stmax - stmin <= xtol * stmax)
+		|| (step == stpmax && f <= ftest && g <= gtest) || (step == stpmin && (f > ftest || g >= gtest)))
+	    return f < finit;
+
+	/* In the first stage, work on the modified function f(a) - f(0) - c1 a g(0)
+	 * as long as it has not gone non-positive with a non-negative derivative */
+	if (stage == 1 && f <= fx && f > ftest) {
+	    double fm = f - step * gtest, gm = g - gtest;
+	    double fxm = fx - stx * gtest, gxm = gx - gtest;
+	    double fym = fy - sty * gtest, gym = gy - gtest;
+
+	    lineSearchStep(stx, fxm, gxm, sty, fym, gym, step, fm, gm, bracketed, stmin, stmax);
+
+	    fx = fxm + stx * gtest; gx = gxm + gtest;
+	    fy = fym + sty * gtest; gy = gym + gtest;
+	} else {
+	    lineSearchStep(stx, fx, gx, sty, fy, gy, step, f, g, bracketed, stmin, stmax);
+	}
+
+	/* Force a sufficient decrease of the interval size */
+	if (bracketed) {
+	    if (std::abs(sty - stx) >= 0.66 * width1)
+		step = stx + 0.5 * (sty - stx);
+	    width1 = width;
+	    width = std::abs(sty - stx);
+
+	    stmin = std::min(stx, sty);
+	    stmax = std::max(stx, sty);
+	} else {
+	    stmin = step + xtrapl * (step - stx);
+	    stmax = step + xtrapu * (step - stx);
+	}
+
+	step = std::max(stpmin, std::min(stpmax, step));
+	if ((bracketed && (step <= stmin || step >= stmax)) || (bracketed && stmax - stmin <= xtol * stmax))
+	    step = stx;
+    }
+
+    /* Out of evaluations: keep the last point only if it decreased the function */
+    return f < finit;
+}
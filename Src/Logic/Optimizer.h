@@ -0,0 +1,114 @@
+/*
+ * Optimizer.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * First order optimizers working on a flat parameter vector: gradient descent
+ * (with momentum or Nesterov acceleration), Adam, and L-BFGS with a
+ * More-Thuente line search. They all share the same stopping criteria and
+ * early stopping on a validation loss.
+ */
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <functional>
+#include "../Eigen/Core"
+
+#define OPTIMIZER_MAX_ITERATIONS 200 //Default safety counter
+#define LBFGS_HISTORY 10 //Number of correction pairs kept by L-BFGS
+#define LINE_SEARCH_MAX_EVALUATIONS 20 //Function evaluations allowed per line search
+
+/* Function to minimize: returns f(x) and writes its gradient */
+class Objective {
+
+	public:
+		virtual ~Objective() {}
+
+		virtual double evaluate(const Eigen::VectorXd &x, Eigen::VectorXd &gradient) = 0;
+};
+
+class Optimizer {
+
+	protected:
+		int mMaxIterations;
+		double mGradientTolerance; //Stop when ||g|| <= tolerance * max(1, ||x||)
+		double mFunctionTolerance; //Stop when |f_k-1 - f_k| <= tolerance * max(1, |f_k|)
+		std::function<bool(int, const Eigen::VectorXd &, double)> mCallback;
+		std::function<double(const Eigen::VectorXd &)> mValidationLoss;
+		int mPatience;
+
+		/* Bookkeeping of one run, shared by every optimizer */
+		double mBestValidationLoss;
+		int mIterationsWithoutProgress;
+		Eigen::VectorXd mBestParameters;
+
+		void start(const Eigen::VectorXd &x);
+		/* Returns true when one of the stopping criteria is met after iteration k */
+		bool stop(int k, const Eigen::VectorXd &x, double f, double previous, const Eigen::VectorXd &gradient);
+		/* Restore the parameters with the best validation loss, if early stopping is on */
+		void finish(Eigen::VectorXd &x);
+
+	public:
+		Optimizer();
+		virtual ~Optimizer() {}
+
+		void setStoppingCriteria(int maxIterations, double gradientTolerance, double functionTolerance);
+		/* Called after every iteration with (iteration, x, f(x)); returning true stops */
+		void setCallback(std::function<bool(int, const Eigen::VectorXd &, double)> callback);
+		/* Stop once the validation loss did not improve for patience iterations,
+		 * and return the parameters that had the lowest one */
+		void setEarlyStopping(std::function<double(const Eigen::VectorXd &)> validationLoss, int patience);
+
+		/* Minimize the objective starting from x; returns the number of iterations */
+		virtual int minimize(Objective &objective, Eigen::VectorXd &x) = 0;
+};
+
+class GradientDescent : public Optimizer {
+
+	private:
+		double mLearningRate;
+		double mMomentum;
+		bool mNesterov;
+
+	public:
+		GradientDescent(double learningRate, double momentum = 0, bool nesterov = false);
+
+		int minimize(Objective &objective, Eigen::VectorXd &x);
+};
+
+class Adam : public Optimizer {
+
+	private:
+		double mLearningRate;
+		double mBeta1;
+		double mBeta2;
+		double mEpsilon;
+
+	public:
+		Adam(double learningRate = 0.001, double beta1 = 0.9, double beta2 = 0.999, double epsilon = 1e-8);
+
+		int minimize(Objective &objective, Eigen::VectorXd &x);
+};
+
+class LBFGS : public Optimizer {
+
+	private:
+		int mHistory;
+		double mFunctionDecrease; //Sufficient decrease constant of the Wolfe conditions
+		double mCurvature; //Curvature constant of the Wolfe conditions
+
+		/* More-Thuente line search along direction from x: on return x, f and gradient
+		 * hold the accepted point and step the accepted step length. Returns false if
+		 * no step satisfying the Wolfe conditions was found */
+		bool lineSearch(Objective &objective, Eigen::VectorXd &x, double &f, Eigen::VectorXd &gradient,
+			const Eigen::VectorXd &direction, double &step);
+
+	public:
+		LBFGS(int history = LBFGS_HISTORY, double functionDecrease = 1e-4, double curvature = 0.9);
+
+		int minimize(Objective &objective, Eigen::VectorXd &x);
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * PCA.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "PCA.h"
+#include "Parallel.h"
+#include "SymmetricRankUpdate.h"
+#include "../Eigen/Eigenvalues"
+#include "../Eigen/QR"
+#include <random>
+
+ProjectionModel::ProjectionModel(const Eigen::VectorXd &mean, const Eigen::MatrixXd &basis,
+	const Eigen::VectorXd &variances) : mMean(mean), mBasis(basis), mVariances(variances) {
+}
+
+Eigen::VectorXd ProjectionModel::project(const Eigen::VectorXd &sample) const {
+    return mBasis.transpose() * (sample - mMean);
+}
+
+void ProjectionModel::project(const Eigen::MatrixXd &samples, Eigen::MatrixXd &projected) const {
+    /* basis^T (X - mean 1^T) = basis^T X - (basis^T mean) 1^T */
+    projected.noalias() = mBasis.transpose() * samples;
+    projected.colwise() -= mBasis.transpose() * mMean;
+}
+
+Eigen::MatrixXd PCA::centered_product(const Eigen::MatrixXd &samples, const Eigen::VectorXd &mean,
+	const Eigen::MatrixXd &right) {
+    Eigen::MatrixXd result(samples.rows(), right.cols());
+    Eigen::RowVectorXd sums = right.colwise().sum();
+    long nbBlocks = (samples.rows() + PCA_BLOCK_SIZE - 1) / PCA_BLOCK_SIZE;
+
+    /* Bands of rows: every task owns its part of the result */
+    parallelFor(nbBlocks, [&](long b) {
+	long from = b * PCA_BLOCK_SIZE, rows = std::min<long>(PCA_BLOCK_SIZE, samples.rows() - from);
+	result.middleRows(from, rows).noalias() = samples.middleRows(from, rows) * right;
+	result.middleRows(from, rows).noalias() -= mean.segment(from, rows) * sums;
+    });
+
+    return result;
+}
+
+Eigen::MatrixXd PCA::centered_transpose_product(const Eigen::MatrixXd &samples, const Eigen::VectorXd &mean,
+	const Eigen::MatrixXd &right) {
+    Eigen::MatrixXd result(samples.cols(), right.cols());
+    Eigen::RowVectorXd shift = mean.transpose() * right;
+    long nbBlocks = (samples.cols() + PCA_BLOCK_SIZE - 1) / PCA_BLOCK_SIZE;
+
+    /* Blocks of samples */
+    parallelFor(nbBlocks, [&](long b) {
+	long from = b * PCA_BLOCK_SIZE, count = std::min<long>(PCA_BLOCK_SIZE, samples.cols() - from);
+	result.middleRows(from, count).noalias() = samples.middleCols(from, count).transpose() * right;
+	result.middleRows(from, count).rowwise() -= shift;
+    });
+
+    return result;
+}
+
+void PCA::orthonormalize(Eigen::MatrixXd &basis) {
+    Eigen::HouseholderQR<Eigen::MatrixXd> qr(basis);
+    basis = qr.householderQ() * Eigen::MatrixXd::Identity(basis.rows(), basis.cols());
+}
+
+ProjectionModel PCA::fit(const Eigen::MatrixXd &samples, int nbComponents) {
+    if (samples.cols() < samples.rows())
+	return fitGram(samples, nbComponents);
+
+    if (4 * (nbComponents + PCA_OVERSAMPLING) < samples.rows())
+	return fitRandomized(samples, nbComponents);
+
+    return fitCovariance(samples, nbComponents);
+}
+
+ProjectionModel PCA::fitCovariance(const Eigen::MatrixXd &samples, int nbComponents) {
+    Eigen::VectorXd mean = samples.rowwise().mean();
+
+    /* Centered chunk by chunk, so that no centered copy of the whole data is made */
+    Eigen::MatrixXd covariance = Eigen::MatrixXd::Zero(samples.rows(), samples.rows());
+    Eigen::MatrixXd centered;
+    for (long from = 0; from < samples.cols(); from += PCA_CHUNK_SIZE) {
+	centered = samples.middleCols(from, std::min<long>(PCA_CHUNK_SIZE, samples.cols() - from)).colwise() - mean;
+	symmetricRankUpdate(covariance, centered);
+    }
+
+    /* Eigenvalues come in increasing order: the components are the last columns */
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(covariance);
+    long k = std::min<long>(nbComponents, samples.rows());
+    Eigen::MatrixXd basis = eig.eigenvectors().rightCols(k).rowwise().reverse();
+    Eigen::VectorXd variances = eig.eigenvalues().tail(k).reverse() / std::max<long>(1, samples.cols() - 1);
+
+    return ProjectionModel(mean, basis, variances);
+}
+
+ProjectionModel PCA::fitRandomized(const Eigen::MatrixXd &samples, int nbComponents, int oversampling,
+	int powerIterations, unsigned int seed) {
+    Eigen::VectorXd mean = samples.rowwise().mean();
+    long k = std::min<long>(nbComponents, std::min(samples.rows(), samples.cols()));
+    long l = std::min<long>(k + oversampling, std::min(samples.rows(), samples.cols()));
+
+    /* Range finder: Q spans A G for a Gaussian G, A being the centered data */
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> normal;
+    Eigen::MatrixXd test = Eigen::MatrixXd::NullaryExpr(samples.cols(), l, [&]() { return normal(generator); });
+
+    Eigen::MatrixXd range = centered_product(samples, mean, test);
+    orthonormalize(range);
+
+    /* Power iterations sharpen the decay of the spectrum, re-orthonormalizing at each step */
+    for (int q = 0; q < powerIterations; q++) {
+	Eigen::MatrixXd coRange = centered_transpose_product(samples, mean, range);
+	orthonormalize(coRange);
+	range = centered_product(samples, mean, coRange);
+	orthonormalize(range);
+    }
+
+    /* B = Q^T A is l x N: the eigenvectors of B B^T rotate Q onto the components */
+    Eigen::MatrixXd projected = centered_transpose_product(samples, mean, range);
+    Eigen::MatrixXd small(l, l);
+    small.setZero();
+    small.selfadjointView<Eigen::Lower>().rankUpdate(projected.transpose());
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(small);
+    Eigen::MatrixXd basis = range * eig.eigenvectors().rightCols(k).rowwise().reverse();
+    Eigen::VectorXd variances = eig.eigenvalues().tail(k).reverse() / std::max<long>(1, samples.cols() - 1);
+
+    return ProjectionModel(mean, basis, variances);
+}
+
+ProjectionModel PCA::fitGram(const Eigen::MatrixXd &samples, int nbComponents) {
+    Eigen::VectorXd mean = samples.rowwise().mean();
+    Eigen::MatrixXd centered(samples.colwise() - mean);
+
+    Eigen::MatrixXd gram = Eigen::MatrixXd::Zero(samples.cols(), samples.cols());
+    symmetricRankUpdate(gram, centered.transpose());
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(gram);
+
+    /* Centering leaves at most N - 1 nonzero eigenvalues: drop the null directions */
+    double threshold = eig.eigenvalues().cwiseAbs().maxCoeff() * samples.cols() * Eigen::NumTraits<double>::epsilon();
+    long k = 0;
+    while (k < std::min<long>(nbComponents, samples.cols()) && eig.eigenvalues()(samples.cols() - 1 - k) > threshold)
+	k++;
+
+    Eigen::VectorXd eigenvalues = eig.eigenvalues().tail(k).reverse();
+    Eigen::MatrixXd basis = centered * eig.eigenvectors().rightCols(k).rowwise().reverse();
+    basis *= eigenvalues.cwiseSqrt().cwiseInverse().asDiagonal();
+
+    return ProjectionModel(mean, basis, eigenvalues / std::max<long>(1, samples.cols() - 1));
+}
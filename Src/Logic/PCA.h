@@ -0,0 +1,74 @@
+/*
+ * PCA.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Principal component analysis of a set of samples (one per column), giving a
+ * ProjectionModel x -> basis^T (x - mean). Besides the full eigendecomposition
+ * of the covariance, the top k components can be found by a randomized range
+ * finder (Halko, Martinsson & Tropp) that only touches the data through
+ * products with thin matrices, the centering being folded into them. With
+ * fewer samples than dimensions the N x N Gram matrix of the centered samples
+ * is decomposed instead, its eigenvectors being mapped back to feature space.
+ */
+
+#ifndef PCA_H
+#define PCA_H
+
+#include "../Eigen/Core"
+
+#define PCA_COMPONENTS 2 //Default number of principal components kept
+#define PCA_OVERSAMPLING 10 //Extra random directions of the range finder
+#define PCA_POWER_ITERATIONS 4 //Subspace iterations of the range finder
+#define PCA_SEED 42 //Seed of the random test matrix
+#define PCA_BLOCK_SIZE 1024 //Rows or samples per parallel task in the products
+#define PCA_CHUNK_SIZE 4096 //Samples centered at a time when accumulating the covariance
+
+class ProjectionModel {
+
+	private:
+		Eigen::VectorXd mMean; //D
+		Eigen::MatrixXd mBasis; //D x k, orthonormal columns for PCA
+		Eigen::VectorXd mVariances; //Variance of the training data along each column of mBasis (PCA), or discriminant ratio (LDA)
+
+	public:
+		ProjectionModel() {}
+		ProjectionModel(const Eigen::VectorXd &mean, const Eigen::MatrixXd &basis, const Eigen::VectorXd &variances);
+
+		Eigen::VectorXd project(const Eigen::VectorXd &sample) const;
+		/* samples: D x N, projected: k x N */
+		void project(const Eigen::MatrixXd &samples, Eigen::MatrixXd &projected) const;
+
+		const Eigen::VectorXd &getMean() const { return mMean; }
+		const Eigen::MatrixXd &getBasis() const { return mBasis; }
+		const Eigen::VectorXd &getVariances() const { return mVariances; }
+		int getNbComponents() const { return mBasis.cols(); }
+};
+
+class PCA {
+
+	private:
+		/* Centered products: (X - mean 1^T) B and (X - mean 1^T)^T B, computed by blocks in parallel */
+		static Eigen::MatrixXd centered_product(const Eigen::MatrixXd &samples, const Eigen::VectorXd &mean,
+			const Eigen::MatrixXd &right);
+		static Eigen::MatrixXd centered_transpose_product(const Eigen::MatrixXd &samples, const Eigen::VectorXd &mean,
+			const Eigen::MatrixXd &right);
+		static void orthonormalize(Eigen::MatrixXd &basis);
+
+	public:
+		/* Picks the cheapest exact-enough method: the Gram matrix when N < D, the randomized
+		 * range finder when k is small next to D, the full covariance otherwise */
+		static ProjectionModel fit(const Eigen::MatrixXd &samples, int nbComponents);
+		/* Eigendecomposition of the full D x D covariance */
+		static ProjectionModel fitCovariance(const Eigen::MatrixXd &samples, int nbComponents);
+		/* Randomized top-k: only D x (k + oversampling) and N x (k + oversampling) matrices are formed */
+		static ProjectionModel fitRandomized(const Eigen::MatrixXd &samples, int nbComponents,
+			int oversampling = PCA_OVERSAMPLING, int powerIterations = PCA_POWER_ITERATIONS,
+			unsigned int seed = PCA_SEED);
+		/* Eigendecomposition of the N x N Gram matrix A^T A of the centered data A: if
+		 * A^T A v = s v then A v / sqrt(s) is a unit eigenvector of A A^T for s */
+		static ProjectionModel fitGram(const Eigen::MatrixXd &samples, int nbComponents);
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Parallel.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Minimal helpers to spread independent tasks over std::threads.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Number of worker threads to use when the caller does not specify one */
+inline unsigned int nbWorkerThreads() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n ? n : 4;
+}
+
+/* Call task(i) for every i in [0, count), tasks being handed out one at a time
+ * to the worker threads. The calling thread works too, so nbThreads == 1 runs
+ * everything serially without spawning anything.
+ * Eigen parallelizes its products with OpenMP in this build, and only skips it
+ * inside an OpenMP parallel region, which a std::thread never is. Each worker
+ * therefore limits its own OpenMP team to one thread while it runs tasks, or
+ * every product would start a full team per worker */
+template <typename Task>
+void parallelFor(long count, Task task, unsigned int nbThreads = 0) {
+    if (!nbThreads)
+	nbThreads = nbWorkerThreads();
+    nbThreads = std::max(1u, (unsigned int) std::min<long>(nbThreads, count));
+
+    std::atomic<long> next(0);
+    auto worker = [&]() {
+#ifdef _OPENMP
+	int previous = omp_get_max_threads();
+	if (nbThreads > 1)
+	    omp_set_num_threads(1);
+#endif
+	for (long i = next++; i < count; i = next++)
+	    task(i);
+#ifdef _OPENMP
+	omp_set_num_threads(previous);
+#endif
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < nbThreads; t++)
+	workers.emplace_back(worker);
+
+    worker();
+
+    for (auto &t : workers)
+	t.join();
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * RandomProjection.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "RandomProjection.h"
+#include "Parallel.h"
+#include <cmath>
+
+/* SplitMix64 finalizer: a counter-based generator, so any entry can be drawn on its own */
+static inline uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* Uniform in (0, 1) from the 53 high bits */
+static inline double uniform(uint64_t x) {
+    return ((x >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+RandomProjection::RandomProjection(int dimension, Distribution distribution, uint64_t seed) {
+    mDimension = dimension;
+    mDistribution = distribution;
+    mSeed = mix(seed);
+}
+
+std::string RandomProjection::getName() const {
+    switch (mDistribution) {
+	case GAUSSIAN: return "Gaussian random projection";
+	case ACHLIOPTAS: return "Achlioptas random projection";
+	default: return "very sparse random projection";
+    }
+}
+
+void RandomProjection::dense_block(long from, long count, long inputSize, Eigen::MatrixXd &block) const {
+    double scale = 1 / std::sqrt(double(mDimension));
+    block.resize(count, inputSize);
+
+    for (long j = 0; j < inputSize; j++)
+	for (long i = 0; i < count; i++) {
+	    uint64_t h = mix(mSeed ^ mix((from + i) * inputSize + j));
+
+	    if (mDistribution == GAUSSIAN) {
+		/* Box-Muller on two draws */
+		block(i, j) = scale * std::sqrt(-2 * std::log(uniform(h))) * std::cos(2 * M_PI * uniform(mix(h)));
+	    } else {
+		double u = uniform(h);
+		block(i, j) = u < 1.0 / 6 ? std::sqrt(3.0) * scale : u < 1.0 / 3 ? -std::sqrt(3.0) * scale : 0;
+	    }
+	}
+}
+
+void RandomProjection::sparse_block(long from, long count, long inputSize,
+	Eigen::SparseMatrix<double, Eigen::RowMajor> &block) const {
+    double s = std::sqrt(double(inputSize));
+    double value = std::sqrt(s / mDimension);
+
+    std::vector<Eigen::Triplet<double> > entries;
+    entries.reserve(2 * count * inputSize / s);
+    for (long i = 0; i < count; i++)
+	for (long j = 0; j < inputSize; j++) {
+	    /* Nonzero with probability 1/s, then +-1 with equal probability */
+	    double u = uniform(mix(mSeed ^ mix((from + i) * inputSize + j)));
+	    if (u < 1 / (2 * s))
+		entries.push_back(Eigen::Triplet<double>(i, j, value));
+	    else if (u < 1 / s)
+		entries.push_back(Eigen::Triplet<double>(i, j, -value));
+	}
+
+    block.resize(count, inputSize);
+    block.setFromTriplets(entries.begin(), entries.end());
+}
+
+void RandomProjection::apply(Eigen::MatrixXd &samples) const {
+    Eigen::MatrixXd projected(mDimension, samples.cols());
+    long nbBlocks = (mDimension + RANDOM_PROJECTION_BLOCK_ROWS - 1) / RANDOM_PROJECTION_BLOCK_ROWS;
+
+    /* Every task regenerates its rows of R and fills the matching rows of the output */
+    parallelFor(nbBlocks, [&](long b) {
+	long from = b * RANDOM_PROJECTION_BLOCK_ROWS;
+	long count = std::min<long>(RANDOM_PROJECTION_BLOCK_ROWS, mDimension - from);
+
+	/* A third of Achlioptas' entries are nonzero: too dense for a sparse product to pay off */
+	if (mDistribution != VERY_SPARSE) {
+	    Eigen::MatrixXd block;
+	    dense_block(from, count, samples.rows(), block);
+	    projected.middleRows(from, count).noalias() = block * samples;
+	} else {
+	    Eigen::SparseMatrix<double, Eigen::RowMajor> block;
+	    sparse_block(from, count, samples.rows(), block);
+	    projected.middleRows(from, count).noalias() = block * samples;
+	}
+    });
+
+    samples.swap(projected);
+}
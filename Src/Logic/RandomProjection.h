@@ -0,0 +1,50 @@
+/*
+ * RandomProjection.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Johnson-Lindenstrauss random projection x -> R x onto k dimensions, with R
+ * k x D drawn from:
+ *  - Gaussian: N(0, 1/k) entries
+ *  - Achlioptas: sqrt(3/k) * {+1, 0, -1} with probabilities {1/6, 2/3, 1/6}
+ *  - very sparse (Li, Hastie & Church): sqrt(s/k) * {+1, 0, -1} with
+ *    probabilities {1/2s, 1 - 1/s, 1/2s}, s = sqrt(D)
+ * Nothing is learned and R is never stored: every entry is a hash of the
+ * seed and its position, so blocks of rows are regenerated when applying it.
+ * The very sparse blocks are built as sparse matrices, the others as dense.
+ */
+
+#ifndef RANDOMPROJECTION_H
+#define RANDOMPROJECTION_H
+
+#include <cstdint>
+#include "Transform.h"
+#include "../Eigen/SparseCore"
+
+#define RANDOM_PROJECTION_SEED 42 //Default seed of the projection matrix
+#define RANDOM_PROJECTION_BLOCK_ROWS 64 //Rows of R generated at a time
+
+class RandomProjection : public Transform {
+
+	public:
+		typedef enum { GAUSSIAN, ACHLIOPTAS, VERY_SPARSE } Distribution;
+
+	private:
+		int mDimension;
+		Distribution mDistribution;
+		uint64_t mSeed;
+
+		/* Rows [from, from + count) of R, for inputs of the given size */
+		void dense_block(long from, long count, long inputSize, Eigen::MatrixXd &block) const;
+		void sparse_block(long from, long count, long inputSize, Eigen::SparseMatrix<double, Eigen::RowMajor> &block) const;
+
+	public:
+		RandomProjection(int dimension, Distribution distribution = GAUSSIAN, uint64_t seed = RANDOM_PROJECTION_SEED);
+
+		void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) {}
+		void apply(Eigen::MatrixXd &samples) const;
+		std::string getName() const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * RidgePath.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "RidgePath.h"
+#include "SymmetricRankUpdate.h"
+#include "../Eigen/Eigenvalues"
+
+RidgePath::RidgePath(const Eigen::MatrixXd &samples, const Eigen::MatrixXd &targets) {
+    bool dual = samples.cols() < samples.rows();
+    Eigen::MatrixXd gram;
+
+    if (dual) {
+	gram.setZero(samples.cols(), samples.cols());
+	symmetricRankUpdate(gram, samples.transpose());
+    } else {
+	gram.setZero(samples.rows(), samples.rows());
+	symmetricRankUpdate(gram, samples);
+    }
+
+    /* Only the lower triangle is read */
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(gram);
+    mEigenvalues = eig.eigenvalues().cwiseMax(0); //Clamp rounding errors of a semi-definite matrix
+
+    if (dual) {
+	mBasis.noalias() = samples * eig.eigenvectors();
+	mCoefficients.noalias() = eig.eigenvectors().transpose() * targets;
+    } else {
+	mBasis = eig.eigenvectors();
+	mCoefficients.noalias() = eig.eigenvectors().transpose() * (samples * targets);
+    }
+}
+
+void RidgePath::weights(double lambda, Eigen::MatrixXd &weights) const {
+    weights.noalias() = mBasis * ((mEigenvalues.array() + lambda).inverse().matrix().asDiagonal() * mCoefficients);
+}
+
+std::vector<double> RidgePath::accuracies(const std::vector<double> &lambdas, const Eigen::MatrixXd &samples,
+	const Eigen::VectorXi &classes) const {
+    long nbClasses = mCoefficients.cols();
+
+    /* [(S + l_1 I)^-1 B, ..., (S + l_L I)^-1 B], r x (C L) */
+    Eigen::MatrixXd scaled(mCoefficients.rows(), nbClasses * lambdas.size());
+    for (unsigned long l = 0; l < lambdas.size(); l++)
+	scaled.middleCols(l * nbClasses, nbClasses) = (mEigenvalues.array() + lambdas[l]).inverse().matrix().asDiagonal()
+	    * mCoefficients;
+
+    Eigen::MatrixXd projected(samples.transpose() * mBasis);
+    Eigen::MatrixXd outputs(projected * scaled); //M x (C L)
+
+    std::vector<double> accuracies(lambdas.size(), 0);
+    for (unsigned long l = 0; l < lambdas.size(); l++) {
+	for (long i = 0; i < outputs.rows(); i++) {
+	    Eigen::Index row, optimum;
+	    outputs.block(i, l * nbClasses, 1, nbClasses).maxCoeff(&row, &optimum);
+	    accuracies[l] += optimum == classes(i);
+	}
+	accuracies[l] /= outputs.rows();
+    }
+
+    return accuracies;
+}
@@ -0,0 +1,40 @@
+/*
+ * RidgePath.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Regularization path of the MSE perceptrons. The Gram matrix is
+ * eigendecomposed once (X X^T = V S V^T, or X^T X = U S U^T when N < D), after
+ * which the weights for any lambda are W(lambda) = P (S + lambda I)^-1 B with
+ * P = V, B = V^T X Y^T in the primal case and P = X U, B = U^T Y^T in the dual
+ * case. Trying a new lambda therefore only costs a diagonal scaling.
+ */
+
+#ifndef RIDGEPATH_H
+#define RIDGEPATH_H
+
+#include <vector>
+#include "../Eigen/Core"
+
+class RidgePath {
+
+	private:
+		Eigen::MatrixXd mBasis; //P, D x r
+		Eigen::VectorXd mEigenvalues; //S, r
+		Eigen::MatrixXd mCoefficients; //B, r x C
+
+	public:
+		/* samples: D x N, targets: N x C */
+		RidgePath(const Eigen::MatrixXd &samples, const Eigen::MatrixXd &targets);
+
+		void weights(double lambda, Eigen::MatrixXd &weights) const;
+
+		/* Fraction of the samples (D x M) whose highest output is their class, for
+		 * every lambda. The samples are projected on P once, and the outputs of all
+		 * the lambdas come out of a single product */
+		std::vector<double> accuracies(const std::vector<double> &lambdas, const Eigen::MatrixXd &samples,
+			const Eigen::VectorXi &classes) const;
+};
+
+#endif
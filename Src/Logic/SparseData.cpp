@@ -0,0 +1,130 @@
+/*
+ * SparseData.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "SparseData.h"
+#include "Parallel.h"
+#include "NormTrick.h"
+#include <cmath>
+
+void SampleMatrix::transposedProduct(const Eigen::Ref<const Eigen::MatrixXd> &weights, Eigen::MatrixXd &outputs) const {
+    if (mSparse)
+	outputs.noalias() = weights.transpose() * *mSparse;
+    else
+	outputs.noalias() = weights.transpose() * *mDense;
+}
+
+void SampleMatrix::productTransposed(const Eigen::MatrixXd &a, double alpha, Eigen::Ref<Eigen::MatrixXd> result) const {
+    if (mSparse)
+	result.noalias() = alpha * (*mSparse * a.transpose());
+    else
+	result.noalias() = alpha * (*mDense * a.transpose());
+}
+
+double SparseData::density(DataInput *data, bool augment) {
+    long size = data->getVectorSize() + (augment ? 1 : 0), nonzeros = 0, nbElements = 0;
+
+    for (auto const &training_class : data->getTrainingElements()) {
+	for (auto const &training_element : training_class.second) {
+	    nonzeros += (training_element.data.array() != 0).count() + (augment ? 1 : 0);
+	    nbElements++;
+	}
+    }
+
+    return nbElements && size ? double(nonzeros) / (nbElements * size) : 1;
+}
+
+void SparseData::training(DataInput *data, SparseSamples &samples, Eigen::VectorXi &classes, bool augment) {
+    std::vector<Eigen::Triplet<double> > entries;
+    long size = data->getVectorSize();
+    classes.resize(data->getNbTrainingElements());
+
+    long i = 0;
+    int c = 0;
+    for (auto const &training_class : data->getTrainingElements()) {
+	for (auto const &training_element : training_class.second) {
+	    for (long d = 0; d < size; d++)
+		if (training_element.data(d) != 0)
+		    entries.push_back(Eigen::Triplet<double>(d, i, training_element.data(d)));
+
+	    if (augment)
+		entries.push_back(Eigen::Triplet<double>(size, i, 1));
+	    classes(i++) = c; //Class index, in the order of the training map
+	}
+	c++;
+    }
+
+    samples.resize(size + (augment ? 1 : 0), i);
+    samples.setFromTriplets(entries.begin(), entries.end());
+}
+
+void SparseData::testing(DataInput *data, SparseSamples &samples) {
+    std::vector<Eigen::Triplet<double> > entries;
+    long size = data->getVectorSize(), i = 0;
+
+    for (auto const &testing_element : data->getTestingElements()) {
+	for (long d = 0; d < size; d++)
+	    if (testing_element.data(d) != 0)
+		entries.push_back(Eigen::Triplet<double>(d, i, testing_element.data(d)));
+	i++;
+    }
+
+    samples.resize(size, i);
+    samples.setFromTriplets(entries.begin(), entries.end());
+}
+
+/* Squared norm of every column, reading only the stored entries */
+static Eigen::VectorXd squared_norms(const SparseSamples &samples) {
+    Eigen::VectorXd norms(samples.cols());
+    for (long j = 0; j < samples.outerSize(); j++) {
+	double norm = 0;
+	for (SparseSamples::InnerIterator it(samples, j); it; ++it)
+	    norm += it.value() * it.value();
+	norms(j) = norm;
+    }
+
+    return norms;
+}
+
+void SparseData::squaredDistances(const SparseSamples &a, const SparseSamples &b, Eigen::MatrixXd &distances) {
+    SparseSamples dots = SparseSamples(a.transpose()) * b;
+    distances = -2 * Eigen::MatrixXd(dots);
+    distances.colwise() += squared_norms(a);
+    distances.rowwise() += squared_norms(b).transpose();
+}
+
+void SparseData::squaredDistances(const SparseSamples &a, const Eigen::MatrixXd &b, Eigen::MatrixXd &distances) {
+    distances.noalias() = -2 * (a.transpose() * b);
+    distances.colwise() += squared_norms(a);
+    distances.rowwise() += b.colwise().squaredNorm();
+}
+
+void SparseData::nearestNeighbours(const SparseSamples &samples, const SparseSamples &queries, std::vector<long> &nearest) {
+    nearest.resize(queries.cols());
+    Eigen::VectorXd norms = squared_norms(samples);
+    double maxNorm = samples.cols() ? std::sqrt(norms.maxCoeff()) : 0;
+    long nbBlocks = (queries.cols() + SPARSE_BLOCK_SIZE - 1) / SPARSE_BLOCK_SIZE;
+
+    /* ||q||^2 is the same for every sample of a query: only ||s||^2 - 2 s.q is ranked. Each
+     * block of queries is made dense, so that the dot products are a sparse-dense product.
+     * The scores too close to the best one to be told apart are re-ranked exactly */
+    parallelFor(nbBlocks, [&](long b) {
+	long from = b * SPARSE_BLOCK_SIZE, count = std::min<long>(SPARSE_BLOCK_SIZE, queries.cols() - from);
+	Eigen::MatrixXd block = Eigen::MatrixXd(queries.middleCols(from, count));
+	Eigen::MatrixXd scores(samples.cols(), count);
+	scores.noalias() = -2 * (samples.transpose() * block);
+	scores.colwise() += norms;
+
+	for (long j = 0; j < count; j++) {
+	    double error = normTrickError(samples.rows(), maxNorm, block.col(j).norm());
+	    nearest[from + j] = normTrickNearest(scores.col(j), error, [&](long i) {
+		Eigen::VectorXd difference = block.col(j);
+		difference -= samples.col(i);
+		return difference.squaredNorm();
+	    });
+	}
+    });
+}
@@ -0,0 +1,71 @@
+/*
+ * SparseData.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Sparse storage of sample matrices (one sample per column, compressed by
+ * column) and the kernels working on it. Squared distances come from
+ * ||a - b||^2 = ||a||^2 + ||b||^2 - 2 a.b, the dot products being one sparse
+ * product per block. The sparse paths only pay off when few entries are
+ * nonzero, so callers pick them from the density of their data.
+ */
+
+#ifndef SPARSEDATA_H
+#define SPARSEDATA_H
+
+#include <vector>
+#include "../Eigen/Core"
+#include "../Eigen/SparseCore"
+#include "../DataInput/DataInput.h"
+
+#define SPARSE_DENSITY_THRESHOLD 0.06 //Below this fraction of nonzero entries the sparse products beat the dense ones
+#define SPARSE_BLOCK_SIZE 256 //Queries per block of distances
+
+typedef Eigen::SparseMatrix<double> SparseSamples; //D x N, compressed by column
+
+/* Training samples held either dense or sparse, with the two products the
+ * perceptron and softmax objectives need. It only points to the samples */
+class SampleMatrix {
+
+	private:
+		const Eigen::MatrixXd *mDense;
+		const SparseSamples *mSparse;
+
+	public:
+		SampleMatrix(const Eigen::MatrixXd &samples) : mDense(&samples), mSparse(nullptr) {}
+		SampleMatrix(const SparseSamples &samples) : mDense(nullptr), mSparse(&samples) {}
+
+		long rows() const { return mSparse ? mSparse->rows() : mDense->rows(); }
+		long cols() const { return mSparse ? mSparse->cols() : mDense->cols(); }
+		bool isSparse() const { return mSparse; }
+
+		/* outputs = W^T X */
+		void transposedProduct(const Eigen::Ref<const Eigen::MatrixXd> &weights, Eigen::MatrixXd &outputs) const;
+		/* result = alpha X A^T */
+		void productTransposed(const Eigen::MatrixXd &a, double alpha, Eigen::Ref<Eigen::MatrixXd> result) const;
+};
+
+class SparseData {
+
+	public:
+		/* Fraction of nonzero entries of the training matrix, counted on the elements so that
+		 * the storage can be picked before either matrix is built; augment adds a row of ones */
+		static double density(DataInput *data, bool augment = false);
+		static bool preferSparse(DataInput *data, bool augment = false) { return density(data, augment) < SPARSE_DENSITY_THRESHOLD; }
+
+		/* Build the sparse matrices straight from the elements, without a dense copy.
+		 * Classes are indices in the order of the training map; augment adds a row of ones */
+		static void training(DataInput *data, SparseSamples &samples, Eigen::VectorXi &classes, bool augment = false);
+		static void testing(DataInput *data, SparseSamples &samples);
+
+		/* distances(i, j) = ||a_i - b_j||^2 for the columns of a (D x M) and b (D x N) */
+		static void squaredDistances(const SparseSamples &a, const SparseSamples &b, Eigen::MatrixXd &distances);
+		static void squaredDistances(const SparseSamples &a, const Eigen::MatrixXd &b, Eigen::MatrixXd &distances);
+
+		/* Index of the nearest column of samples for every column of queries, by blocks of
+		 * queries in parallel */
+		static void nearestNeighbours(const SparseSamples &samples, const SparseSamples &queries, std::vector<long> &nearest);
+};
+
+#endif
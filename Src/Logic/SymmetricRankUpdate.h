@@ -0,0 +1,49 @@
+/*
+ * SymmetricRankUpdate.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Multithreaded symmetric rank-k update (SYRK): the lower triangle of a
+ * symmetric matrix accumulates alpha A A^T, which is how the covariance and
+ * Gram matrices of PCA and of the MSE normal equations are built. Only the
+ * lower triangle is computed, and calls add up, so a product over a large
+ * training set can be accumulated chunk by chunk.
+ */
+
+#ifndef SYMMETRICRANKUPDATE_H
+#define SYMMETRICRANKUPDATE_H
+
+#include <cmath>
+#include "Parallel.h"
+#include "../Eigen/Core"
+
+/* result += alpha A A^T on the lower triangle; A can be any expression, such as
+ * samples.transpose() for a Gram matrix. The triangle is cut in horizontal bands
+ * of equal area, so that every band costs about the same: band b covers rows
+ * [n sqrt(b/B), n sqrt((b+1)/B)). Each band is a GEMM left of the diagonal plus a
+ * serial rankUpdate (Eigen's GeneralMatrixMatrixTriangular) on its diagonal block */
+template <typename Derived>
+void symmetricRankUpdate(Eigen::MatrixXd &result, const Eigen::MatrixBase<Derived> &factor, double alpha = 1,
+	unsigned int nbThreads = 0) {
+    if (!nbThreads)
+	nbThreads = nbWorkerThreads();
+
+    long size = result.rows();
+    long nbBands = nbThreads == 1 ? 1 : 4 * nbThreads;
+    std::vector<long> bounds(nbBands + 1);
+    for (long b = 0; b <= nbBands; b++)
+	bounds[b] = std::lround(size * std::sqrt(double(b) / nbBands));
+
+    parallelFor(nbBands, [&](long b) {
+	long from = bounds[b], rows = bounds[b + 1] - bounds[b];
+	if (!rows)
+	    return;
+
+	result.block(from, 0, rows, from).noalias() += alpha * factor.middleRows(from, rows) * factor.topRows(from).transpose();
+	result.block(from, from, rows, rows).template selfadjointView<Eigen::Lower>()
+	    .rankUpdate(factor.middleRows(from, rows), alpha);
+    }, nbThreads);
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Transform.cpp
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "Transform.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+void Centering::fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) {
+    mMean = samples.rowwise().mean();
+}
+
+void Centering::apply(Eigen::MatrixXd &samples) const {
+    samples.colwise() -= mMean;
+}
+
+void PCATransform::fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) {
+    mModel = PCA::fit(samples, mNbComponents);
+}
+
+void PCATransform::apply(Eigen::MatrixXd &samples) const {
+    Eigen::MatrixXd projected;
+    mModel.project(samples, projected);
+    samples.swap(projected);
+}
+
+void IncrementalPCATransform::fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) {
+    IncrementalPCA pca(samples.rows(), mNbComponents);
+    for (long from = 0; from < samples.cols(); from += mBatchSize)
+	pca.update(samples.middleCols(from, std::min(mBatchSize, samples.cols() - from)));
+
+    mModel = pca.model();
+}
+
+void IncrementalPCATransform::apply(Eigen::MatrixXd &samples) const {
+    Eigen::MatrixXd projected;
+    mModel.project(samples, projected);
+    samples.swap(projected);
+}
+
+void LDATransform::fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) {
+    mModel = LDA::fit(samples, classes, classes.size() ? classes.maxCoeff() + 1 : 0, mNbComponents);
+}
+
+void LDATransform::apply(Eigen::MatrixXd &samples) const {
+    Eigen::MatrixXd projected;
+    mModel.project(samples, projected);
+    samples.swap(projected);
+}
+
+void Whitening::fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) {
+    Eigen::VectorXd mean = samples.rowwise().mean();
+    Eigen::VectorXd variances = (samples.colwise() - mean).rowwise().squaredNorm() / std::max<long>(1, samples.cols() - 1);
+    mScales = (variances.array() + WHITENING_EPSILON).rsqrt();
+}
+
+void Whitening::apply(Eigen::MatrixXd &samples) const {
+    samples = mScales.asDiagonal() * samples;
+}
+
+void Normalization::apply(Eigen::MatrixXd &samples) const {
+    Eigen::RowVectorXd norms = samples.colwise().norm();
+    samples.array().rowwise() /= (norms.array() > 0).select(norms.array(), 1);
+}
+
+TransformPipeline &TransformPipeline::add(Transform *transform) {
+    mTransforms.emplace_back(transform);
+    return *this;
+}
+
+TransformedData *TransformPipeline::transform(DataInput *data) {
+    std::cout << "* Transforming the data..." << std::endl;
+
+    Eigen::MatrixXd training(data->getVectorSize(), data->getNbTrainingElements());
+    Eigen::MatrixXd testing(data->getVectorSize(), data->getTestingElements().size());
+    Eigen::VectorXi classes(training.cols());
+
+    int i = 0, c = 0;
+    for (auto const &training_class : data->getTrainingElements()) {
+	for (auto const &training_element : training_class.second) {
+	    classes(i) = c; //Class index, in the order of the training map
+	    training.col(i++) = training_element.data;
+	}
+	c++;
+    }
+
+    i = 0;
+    for (auto const &testing_element : data->getTestingElements())
+	testing.col(i++) = testing_element.data;
+
+    /* Each transform is fitted on the output of the previous ones */
+    for (auto const &transform : mTransforms) {
+	auto begin = std::chrono::steady_clock::now();
+	transform->fit(training, classes);
+	transform->apply(training);
+	transform->apply(testing);
+	auto end = std::chrono::steady_clock::now();
+
+	std::cout << "\t -> " << transform->getName() << ": " << training.rows() << " features ("
+	    << std::chrono::duration<double>(end - begin).count() << "s)" << std::endl;
+    }
+
+    std::cout << "* Data transformed !" << std::endl << std::endl;
+
+    return new TransformedData(data, training, testing);
+}
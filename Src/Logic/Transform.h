@@ -0,0 +1,135 @@
+/*
+ * Transform.h
+ * Copyright (C) 2017 transpalette <transpalette@arch-cactus>
+ *
+ * Distributed under terms of the MIT license.
+ *
+ * Feature transforms fitted on the training set and applied to whole sample
+ * matrices (one sample per column) at once, and a pipeline chaining them into
+ * a TransformedData next to the original dataset.
+ */
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <memory>
+#include <string>
+#include "PCA.h"
+#include "IncrementalPCA.h"
+#include "LDA.h"
+#include "../DataInput/TransformedData.h"
+
+#define WHITENING_EPSILON 1e-8 //Added to the variances before whitening, for flat features
+
+class Transform {
+
+	public:
+		virtual ~Transform() {}
+
+		/* Learn the parameters from the training samples (D x N) and their class indices;
+		 * unsupervised transforms ignore the classes */
+		virtual void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) = 0;
+		/* Transform the samples in place; the number of rows may change */
+		virtual void apply(Eigen::MatrixXd &samples) const = 0;
+		virtual std::string getName() const = 0;
+};
+
+/* x - mean */
+class Centering : public Transform {
+
+	private:
+		Eigen::VectorXd mMean;
+
+	public:
+		void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes);
+		void apply(Eigen::MatrixXd &samples) const;
+		std::string getName() const { return "centering"; }
+};
+
+/* Projection on the top principal components, fitted with PCA::fit */
+class PCATransform : public Transform {
+
+	private:
+		int mNbComponents;
+		ProjectionModel mModel;
+
+	public:
+		explicit PCATransform(int nbComponents = PCA_COMPONENTS) : mNbComponents(nbComponents) {}
+
+		void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes);
+		void apply(Eigen::MatrixXd &samples) const;
+		std::string getName() const { return "PCA"; }
+		const ProjectionModel &getModel() const { return mModel; }
+};
+
+/* Same projection, fitted by IncrementalPCA from batches of the training samples */
+class IncrementalPCATransform : public Transform {
+
+	private:
+		int mNbComponents;
+		long mBatchSize;
+		ProjectionModel mModel;
+
+	public:
+		explicit IncrementalPCATransform(int nbComponents = PCA_COMPONENTS, long batchSize = INCREMENTAL_PCA_BATCH_SIZE)
+			: mNbComponents(nbComponents), mBatchSize(batchSize) {}
+
+		void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes);
+		void apply(Eigen::MatrixXd &samples) const;
+		std::string getName() const { return "incremental PCA"; }
+		const ProjectionModel &getModel() const { return mModel; }
+};
+
+/* Projection on the Fisher discriminant directions, at most C - 1 of them */
+class LDATransform : public Transform {
+
+	private:
+		int mNbComponents;
+		ProjectionModel mModel;
+
+	public:
+		explicit LDATransform(int nbComponents = 0) : mNbComponents(nbComponents) {}
+
+		void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes);
+		void apply(Eigen::MatrixXd &samples) const;
+		std::string getName() const { return "LDA"; }
+		const ProjectionModel &getModel() const { return mModel; }
+};
+
+/* Every feature divided by its standard deviation on the training set: after a
+ * PCATransform the features are uncorrelated, so this whitens them */
+class Whitening : public Transform {
+
+	private:
+		Eigen::VectorXd mScales;
+
+	public:
+		void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes);
+		void apply(Eigen::MatrixXd &samples) const;
+		std::string getName() const { return "whitening"; }
+};
+
+/* Every sample scaled to unit Euclidean norm (nothing to fit) */
+class Normalization : public Transform {
+
+	public:
+		void fit(const Eigen::MatrixXd &samples, const Eigen::VectorXi &classes) {}
+		void apply(Eigen::MatrixXd &samples) const;
+		std::string getName() const { return "normalization"; }
+};
+
+class TransformPipeline {
+
+	private:
+		std::vector<std::unique_ptr<Transform> > mTransforms;
+
+	public:
+		/* The pipeline takes ownership of the transform */
+		TransformPipeline &add(Transform *transform);
+
+		/* Fit every transform in turn on the training set of data, then build the derived
+		 * dataset. data is only read: raw and transformed sets can be used side by side */
+		TransformedData *transform(DataInput *data);
+};
+
+#endif
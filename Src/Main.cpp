@@ -6,22 +6,133 @@
  */
 
 #include "Logic/Algorithm.h"
+#include "Logic/Transform.h"
+#include "Logic/FeatureSelection.h"
+#include <string>
+
+/* The faster variants against their reference, on MNIST */
+static int runBenchmarks() {
+	MNISTData *digits = new MNISTData(10, 28, 28);
+	digits->loadDirectory("../DataSets/MNIST"); //Use full path
+	Algorithm algo(digits);
+
+	std::cout << "--- MNIST: random projections ---" << std::endl << std::endl;
+
+	Algorithm::generateCSV("random_projection_MNIST.csv", algo.benchmarkRandomProjection({50, 100, 200}));
+
+	std::cout << "--- MNIST: centroids ---" << std::endl << std::endl;
+
+	std::vector<double> centroidScores, centroidExecTimes;
+	centroidExecTimes.push_back(algo.nearestClassCentroid());
+	centroidScores.push_back(algo.calculateAccuracy() * 100);
+	centroidExecTimes.push_back(algo.onlineNearestClassCentroid(1000));
+	centroidScores.push_back(algo.calculateAccuracy() * 100);
+	/* Same sub classes (K-means starts from the first elements), searched flat then through a CentroidTree */
+	centroidExecTimes.push_back(algo.nearestSubClassCentroid(10));
+	centroidScores.push_back(algo.calculateAccuracy() * 100);
+	centroidExecTimes.push_back(algo.nearestSubClassCentroid(10, true));
+	centroidScores.push_back(algo.calculateAccuracy() * 100);
+	Algorithm::generateCSV("centroids_MNIST.csv", {centroidScores, centroidExecTimes});
+
+	std::cout << "--- MNIST: nearest neighbour ---" << std::endl << std::endl;
+
+	std::vector<double> nnScores, nnExecTimes;
+	std::vector<std::vector<double> > nnCSV;
+	nnExecTimes.push_back(algo.blockedNearestNeighbour());
+	nnScores.push_back(algo.calculateAccuracy() * 100);
+	nnExecTimes.push_back(algo.pyramidNearestNeighbour());
+	nnScores.push_back(algo.calculateAccuracy() * 100);
+	nnExecTimes.push_back(algo.mixedPrecisionNearestNeighbour());
+	nnScores.push_back(algo.calculateAccuracy() * 100);
+
+	nnCSV.push_back(nnScores);
+	nnCSV.push_back(nnExecTimes);
+	nnCSV.push_back(algo.benchmarkBinaryNearestNeighbour(1));
+	nnCSV.push_back(algo.benchmarkBinaryNearestNeighbour(3));
+	Algorithm::generateCSV("nearest_neighbour_MNIST.csv", nnCSV);
+
+	std::cout << "--- MNIST: metrics ---" << std::endl << std::endl;
+
+	/* Row: NN, NCC and NSC (2 sub-classes) under the cosine, then the Mahalanobis distance */
+	std::vector<double> metricScores, metricExecTimes;
+	metricExecTimes.push_back(algo.metricNearestNeighbour<CosineMetric>());
+	metricScores.push_back(algo.calculateAccuracy() * 100);
+	metricExecTimes.push_back(algo.metricNearestClassCentroid<CosineMetric>());
+	metricScores.push_back(algo.calculateAccuracy() * 100);
+	metricExecTimes.push_back(algo.metricNearestSubClassCentroid<CosineMetric>(2));
+	metricScores.push_back(algo.calculateAccuracy() * 100);
+	metricExecTimes.push_back(algo.metricNearestNeighbour<MahalanobisMetric>());
+	metricScores.push_back(algo.calculateAccuracy() * 100);
+	metricExecTimes.push_back(algo.metricNearestClassCentroid<MahalanobisMetric>());
+	metricScores.push_back(algo.calculateAccuracy() * 100);
+	metricExecTimes.push_back(algo.metricNearestSubClassCentroid<MahalanobisMetric>(2));
+	metricScores.push_back(algo.calculateAccuracy() * 100);
+	Algorithm::generateCSV("metrics_MNIST.csv", {metricScores, metricExecTimes});
+
+	std::cout << "--- MNIST: training ---" << std::endl << std::endl;
+
+	std::vector<std::vector<double> > trainingCSV;
+	trainingCSV.push_back(algo.benchmarkSymmetricRankUpdate());
+	trainingCSV.push_back(algo.benchmarkPCA(PCA_COMPONENTS));
+	trainingCSV.push_back(algo.benchmarkPerceptronTrainers(0.9));
+	double softmaxTime = algo.softmaxRegression();
+	trainingCSV.push_back({softmaxTime, algo.calculateAccuracy()});
+	trainingCSV.push_back(algo.benchmarkMSESolvers({1e-4, 1e-3, 1e-2, 1e-1, 1, 10}));
+	Algorithm::generateCSV("training_MNIST.csv", trainingCSV);
+
+	std::cout << "--- MNIST: PCA ---" << std::endl << std::endl;
+
+	/* NCC on the batch and on the incremental PCA of the data */
+	std::vector<double> pcaScores, pcaExecTimes;
+	TransformPipeline pca, incrementalPCA;
+	pca.add(new PCATransform(PCA_COMPONENTS));
+	incrementalPCA.add(new IncrementalPCATransform(PCA_COMPONENTS));
+	TransformPipeline *pipelines[] = {&pca, &incrementalPCA};
+	for (TransformPipeline *pipeline : pipelines) {
+		Algorithm projected(pipeline->transform(digits));
+		pcaExecTimes.push_back(projected.nearestClassCentroid());
+		pcaScores.push_back(projected.calculateAccuracy() * 100);
+	}
+	Algorithm::generateCSV("pca_MNIST.csv", {pcaScores, pcaExecTimes});
+
+	std::cout << "--- MNIST: LDA ---" << std::endl << std::endl;
+
+	/* Last: the data is projected in place */
+	std::vector<double> ldaScores, ldaExecTimes;
+	algo.applyLDA();
+	ldaExecTimes.push_back(algo.nearestClassCentroid());
+	ldaScores.push_back(algo.calculateAccuracy() * 100);
+	ldaExecTimes.push_back(algo.blockedNearestNeighbour());
+	ldaScores.push_back(algo.calculateAccuracy() * 100);
+	Algorithm::generateCSV("lda_MNIST.csv", {ldaScores, ldaExecTimes});
+
+	return 0;
+}
 
 int main(int argc, char  **argv) {
 
 	srand((unsigned) time(NULL));
 
+	/* ./OptimizationAlgorithms --benchmarks runs the benchmarks instead of the experiments */
+	if (argc > 1 && std::string(argv[1]) == "--benchmarks")
+		return runBenchmarks();
+
 	std::vector<double> orl_originalScores, orl_originalExecTimes, orl_pcaScores, orl_pcaExecTimes;
 	std::vector<double> mnist_originalScores, mnist_originalExecTimes, mnist_pcaScores, mnist_pcaExecTimes;
+	std::vector<double> mnist_prunedScores, mnist_prunedExecTimes;
 	std::vector<std::vector<double> > firstCSV, secondCSV;
 
+	/* Each dataset is loaded once; its PCA version is derived next to it */
+	TransformPipeline pca;
+	pca.add(new PCATransform(PCA_COMPONENTS));
+
 	std::cout << "--- Using ORL dataset: PCA version ---" << std::endl << std::endl;
 
-	ORLData *facesForPCA = new ORLData(40, 30, 40, 400);
-	facesForPCA->loadDirectory("../DataSets/ORL");
+	ORLData *faces = new ORLData(40, 30, 40, 400);
+	faces->loadDirectory("../DataSets/ORL");
 	
-	Algorithm algoAPCA(facesForPCA);
-	algoAPCA.applyPCA();
+	Algorithm algoAPCA(pca.transform(faces));
+	algoAPCA.generatePCACSV(); //Overwritten by the MNIST one below, as when applyPCA wrote it
 
 	orl_pcaExecTimes.push_back(algoAPCA.nearestClassCentroid());
 	orl_pcaScores.push_back(algoAPCA.calculateAccuracy() * 100);
@@ -40,9 +151,6 @@ int main(int argc, char  **argv) {
 
 	std::cout << "--- Using ORL dataset ---" << std::endl << std::endl;
 
-	ORLData *faces = new ORLData(40, 30, 40, 400);
-	faces->loadDirectory("../DataSets/ORL");
-
 	Algorithm algoA(faces);
 	orl_originalExecTimes.push_back(algoA.nearestClassCentroid());
 	orl_originalScores.push_back(algoA.calculateAccuracy() * 100);
@@ -69,11 +177,11 @@ int main(int argc, char  **argv) {
 	std::cout << "--- Using MNIST dataset: PCA ---" << std::endl << std::endl;
 	
 	int ch = std::cin.get();
-	MNISTData *digitsPCA = new MNISTData(10, 28, 28);
-	digitsPCA->loadDirectory("../DataSets/MNIST"); //Use full path
+	MNISTData *digits = new MNISTData(10, 28, 28);
+	digits->loadDirectory("../DataSets/MNIST"); //Use full path
 
-	Algorithm algoBPCA(digitsPCA);
-	algoBPCA.applyPCA();
+	Algorithm algoBPCA(pca.transform(digits));
+	algoBPCA.generatePCACSV();
 	mnist_pcaExecTimes.push_back(algoBPCA.nearestClassCentroid());
 	mnist_pcaScores.push_back(algoBPCA.calculateAccuracy() * 100);
 	mnist_pcaExecTimes.push_back(algoBPCA.nearestSubClassCentroid(2));
@@ -89,10 +197,29 @@ int main(int argc, char  **argv) {
 	mnist_pcaExecTimes.push_back(algoBPCA.perceptronMSE());
 	mnist_pcaScores.push_back(algoBPCA.calculateAccuracy() * 100);
 
-	std::cout << "--- Using MNIST dataset ---" << std::endl << std::endl;
+	std::cout << "--- Using MNIST dataset: pruned features ---" << std::endl << std::endl;
+
+	/* Drop the blank border pixels and the ones almost never inked, next to the raw data */
+	TransformPipeline pruning;
+	pruning.add(new FeatureSelection());
+
+	Algorithm algoBPruned(pruning.transform(digits));
+	mnist_prunedExecTimes.push_back(algoBPruned.nearestClassCentroid());
+	mnist_prunedScores.push_back(algoBPruned.calculateAccuracy() * 100);
+	mnist_prunedExecTimes.push_back(algoBPruned.nearestSubClassCentroid(2));
+	mnist_prunedScores.push_back(algoBPruned.calculateAccuracy() * 100);
+	mnist_prunedExecTimes.push_back(algoBPruned.nearestSubClassCentroid(3));
+	mnist_prunedScores.push_back(algoBPruned.calculateAccuracy() * 100);
+	mnist_prunedExecTimes.push_back(algoBPruned.nearestSubClassCentroid(5));
+	mnist_prunedScores.push_back(algoBPruned.calculateAccuracy() * 100);
+	mnist_prunedExecTimes.push_back(algoBPruned.threadedNearestNeighbour());
+	mnist_prunedScores.push_back(algoBPruned.calculateAccuracy() * 100);
+	mnist_prunedExecTimes.push_back(algoBPruned.perceptronBPG());
+	mnist_prunedScores.push_back(algoBPruned.calculateAccuracy() * 100);
+	mnist_prunedExecTimes.push_back(algoBPruned.perceptronMSE());
+	mnist_prunedScores.push_back(algoBPruned.calculateAccuracy() * 100);
 
-	MNISTData *digits = new MNISTData(10, 28, 28);
-	digits->loadDirectory("../DataSets/MNIST"); //Use full path
+	std::cout << "--- Using MNIST dataset ---" << std::endl << std::endl;
 
 	Algorithm algoB(digits);
 	mnist_originalExecTimes.push_back(algoB.nearestClassCentroid());
@@ -114,6 +241,8 @@ int main(int argc, char  **argv) {
 	secondCSV.push_back(mnist_originalExecTimes);
 	secondCSV.push_back(mnist_pcaScores);
 	secondCSV.push_back(mnist_pcaExecTimes);
+	secondCSV.push_back(mnist_prunedScores);
+	secondCSV.push_back(mnist_prunedExecTimes);
 
 	Algorithm::generateCSV("scores_and_times_MNIST.csv", firstCSV);
 